@@ -2,6 +2,7 @@
 #include <SD.h>
 #include <Adafruit_GFX.h>    // Core graphics library
 #include "Adafruit_ILI9341.h" // Hardware-specific library
+#include <gfxcore.h>          // Enginaator2024SampleCode/components/gfxcore, installed as a library
 
 #define LED_BUILTIN 2
 
@@ -12,35 +13,15 @@
 #define TFT_RESET 22
 
 #define MAX_BMP_LINE_LENGTH 320u
-#define CONVERT_888RGB_TO_565BGR(b, g, r) ((r >> 3) | ((g >> 2) << 5) | ((b >> 3) << 11))
-
-/** Private type definitions **/
-
-#pragma pack(push)  // save the original data alignment
-#pragma pack(1)     // Set data alignment to 1 byte boundary
-typedef struct {
-    uint16_t type;              // Magic identifier: 0x4d42
-    uint32_t size;              // File size in bytes
-    uint16_t reserved1;         // Not used
-    uint16_t reserved2;         // Not used
-    uint32_t offset;            // Offset to image data in bytes from beginning of file
-    uint32_t dib_header_size;   // DIB Header size in bytes
-    int32_t  width_px;          // Width of the image
-    int32_t  height_px;         // Height of image
-    uint16_t num_planes;        // Number of color planes
-    uint16_t bits_per_pixel;    // Bits per pixel
-    uint32_t compression;       // Compression type
-    uint32_t image_size_bytes;  // Image size in bytes
-    int32_t  x_resolution_ppm;  // Pixels per meter
-    int32_t  y_resolution_ppm;  // Pixels per meter
-    uint32_t num_colors;        // Number of colors
-    uint32_t important_colors;  // Important colors
-} BMPHeader;
-#pragma pack(pop)  // restore the previous pack setting
+
+/* Images are decoded and drawn this many rows at a time, so only one band has to fit in RAM. */
+#define BMP_BAND_ROWS 24u
 
 /** Private function forward declarations **/
 
-void loadBmp(char * path, uint16_t * output_buffer);
+void drawBmp(const char * path, int16_t x, int16_t y);
+static int bmpRead(void * ctx, uint32_t offset, void * buf, uint32_t len);
+static void bmpDrawBand(void * ctx, int first_row, int number_of_rows, int width, uint16_t * pixels);
 
 /** Private variable declarations **/
 Adafruit_ILI9341 tft = Adafruit_ILI9341(TFT_CS, TFT_DC);
@@ -48,10 +29,12 @@ bool isInitComplete = false;
 char str_buffer[128];
 
 uint16_t test_buffer[40*40];
-uint8_t  bmp_line_buffer[(MAX_BMP_LINE_LENGTH * 3) + 4u];
-//static uint16_t frame_buffer[320*240]; //Cannot get this much contiguous memory.
-static uint16_t frame_buffer1[320*120];
-//static uint16_t frame_buffer2[320*120];
+static uint32_t bmp_line_buffer[BMPSTREAM_LINE_BUFFER_WORDS(MAX_BMP_LINE_LENGTH)];
+static uint16_t bmp_band_buffer[MAX_BMP_LINE_LENGTH * BMP_BAND_ROWS];
+
+/* Where the band callback draws the image. */
+static int16_t bmp_draw_x;
+static int16_t bmp_draw_y;
 
 /** Public functions **/
 void setup() 
@@ -80,11 +63,8 @@ void setup()
 
   tft.fillScreen(ILI9341_BLUE);
 
-  loadBmp("/logo_upper.bmp", frame_buffer1);
-  tft.drawRGBBitmap(0,0,frame_buffer1,320,120);
-
-  loadBmp("/logo_lower.bmp", frame_buffer1);
-  tft.drawRGBBitmap(0,120,frame_buffer1,320,120);
+  /* The whole logo in one go, it never has to fit in RAM. */
+  drawBmp("/logo.bmp", 0, 0);
 
   isInitComplete = true;
 }
@@ -103,49 +83,62 @@ void loop()
   delay(1000);                      // wait for a second
 }
 
-void loadBmp(char * path, uint16_t * output_buffer)
+void drawBmp(const char * path, int16_t x, int16_t y)
 {
-  File     bmpFile;
-  BMPHeader header;
-  uint16_t line_stride;
-  uint16_t line_px_data_len;
-  uint16_t * dest_ptr = output_buffer;
+  File bmpFile;
+  BmpStreamConfig_T config;
+  BmpStreamInfo_T info;
+  int res;
 
   bmpFile = SD.open(path, FILE_READ);
 
-  if (bmpFile == NULL) 
+  if (!bmpFile)
   {
     Serial.println(F("File not found"));
+    return;
+  }
+
+  bmp_draw_x = x;
+  bmp_draw_y = y;
+
+  memset(&config, 0, sizeof(config));
+  config.read = bmpRead;
+  config.read_ctx = &bmpFile;
+  config.sink = bmpDrawBand;
+  config.line_buf = bmp_line_buffer;
+  config.line_buf_words = sizeof(bmp_line_buffer) / sizeof(bmp_line_buffer[0]);
+  config.band_buf = bmp_band_buffer;
+  config.band_buf_pixels = sizeof(bmp_band_buffer) / sizeof(bmp_band_buffer[0]);
+  config.format = BMPSTREAM_PIXELS_RGB565;
+
+  res = bmpStream_decode(&config, &info);
+
+  if (res == BMPSTREAM_OK)
+  {
+    sprintf(str_buffer, "Bitmap %s : %ld x %ld", path, (long)info.width, (long)info.height);
   }
   else
   {
-    Serial.println(F("File opened successfully."));
+    sprintf(str_buffer, "Failed to draw %s (%d)", path, res);
   }
-
-  bmpFile.readBytes((char *)&header, sizeof(BMPHeader));
-
-  sprintf(str_buffer, "Bitmap width : %d", header.width_px);
-  Serial.println(str_buffer);
-  sprintf(str_buffer, "Bitmap height : %d", header.height_px);
   Serial.println(str_buffer);
 
-  /* Now lets try and read RGB data... */
+  bmpFile.close();
+}
 
-  /* Take padding into account... */
-  line_px_data_len = header.width_px * 3u;
-  line_stride = (line_px_data_len + 3u) & ~0x03;
+static int bmpRead(void * ctx, uint32_t offset, void * buf, uint32_t len)
+{
+  File * f = (File *)ctx;
 
-  for (int y = 0u; y < header.height_px; y++)
+  if (!f->seek(offset))
   {
-    //file_res = f_lseek(&priv_f_obj, ((priv_bmp_header.height_px - (y + 1)) * line_stride) + priv_bmp_header.offset);
-    //file_res = f_read(&priv_f_obj, priv_bmp_line_buffer, line_stride, &bytes_read);
+    return -1;
+  }
 
-    bmpFile.seek(((header.height_px - (y + 1)) * line_stride) + header.offset);
-    bmpFile.readBytes((char *)&bmp_line_buffer, line_stride);
+  return (f->read((uint8_t *)buf, len) == (int)len) ? 0 : -1;
+}
 
-    for (int x = 0u; x < line_px_data_len; x+=3u )
-    {
-      *dest_ptr++ = CONVERT_888RGB_TO_565BGR(bmp_line_buffer[x+2], bmp_line_buffer[x+1], bmp_line_buffer[x]);
-    }
-  }
+static void bmpDrawBand(void * ctx, int first_row, int number_of_rows, int width, uint16_t * pixels)
+{
+  tft.drawRGBBitmap(bmp_draw_x, bmp_draw_y + first_row, pixels, width, number_of_rows);
 }
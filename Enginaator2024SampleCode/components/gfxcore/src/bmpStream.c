@@ -0,0 +1,171 @@
+/*
+ * bmpStream.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "bmpStream.h"
+#include "colorConv.h"
+
+/****************** Private defines *******************/
+
+#define BMP_MAGIC 0x4d42u
+
+#define BMP_COMPRESSION_NONE		0u
+#define BMP_COMPRESSION_BITFIELDS	3u
+
+/****************** Private type definitions *******************/
+
+#pragma pack(push)  // save the original data alignment
+#pragma pack(1)     // Set data alignment to 1 byte boundary
+typedef struct
+{
+    uint16_t type;              // Magic identifier: 0x4d42
+    uint32_t size;              // File size in bytes
+    uint16_t reserved1;         // Not used
+    uint16_t reserved2;         // Not used
+    uint32_t offset;            // Offset to image data in bytes from beginning of file
+    uint32_t dib_header_size;   // DIB Header size in bytes
+    int32_t  width_px;          // Width of the image
+    int32_t  height_px;         // Height of image
+    uint16_t num_planes;        // Number of color planes
+    uint16_t bits_per_pixel;    // Bits per pixel
+    uint32_t compression;       // Compression type
+    uint32_t image_size_bytes;  // Image size in bytes
+    int32_t  x_resolution_ppm;  // Pixels per meter
+    int32_t  y_resolution_ppm;  // Pixels per meter
+    uint32_t num_colors;        // Number of colors
+    uint32_t important_colors;  // Important colors
+} BMPHeader;
+#pragma pack(pop)  // restore the previous pack setting
+
+/**************** Public functions  **************/
+
+int bmpStream_readInfo(BmpStream_Read_T read, void * read_ctx, BmpStreamInfo_T * info)
+{
+	BMPHeader header;
+
+	if (read(read_ctx, 0u, &header, sizeof(BMPHeader)) != 0)
+	{
+		return BMPSTREAM_ERR_READ;
+	}
+
+	if ((header.type != BMP_MAGIC) ||
+		((header.bits_per_pixel != 24u) && (header.bits_per_pixel != 32u)) ||
+		((header.compression != BMP_COMPRESSION_NONE) && (header.compression != BMP_COMPRESSION_BITFIELDS)) ||
+		(header.width_px <= 0) || (header.height_px == 0) || (header.height_px == INT32_MIN))
+	{
+		return BMPSTREAM_ERR_FORMAT;
+	}
+
+	info->width = header.width_px;
+	info->bits_per_pixel = header.bits_per_pixel;
+	info->data_offset = header.offset;
+
+	/* A negative height means the rows are stored top down. */
+	info->is_top_down = (header.height_px < 0);
+	info->height = info->is_top_down ? -header.height_px : header.height_px;
+
+	return BMPSTREAM_OK;
+}
+
+
+int bmpStream_decode(const BmpStreamConfig_T * config, BmpStreamInfo_T * info)
+{
+	BmpStreamInfo_T local_info;
+	uint64_t line_px_data_len;
+	uint64_t line_stride;
+	uint32_t band_rows;
+	uint32_t file_row;
+	uint16_t * band;
+	uint16_t * dest_ptr;
+	int rows;
+	int res;
+
+	if (info == NULL)
+	{
+		info = &local_info;
+	}
+
+	res = bmpStream_readInfo(config->read, config->read_ctx, info);
+	if (res != BMPSTREAM_OK)
+	{
+		return res;
+	}
+
+	/* A line never takes more words than it has pixels, so this bounds the width before anything is multiplied by it. */
+	if ((uint32_t)info->width > config->line_buf_words)
+	{
+		return BMPSTREAM_ERR_BUFFER;
+	}
+
+	/* Take padding into account... The sizes come from the file, so they are checked in 64 bits. */
+	line_px_data_len = (uint64_t)info->width * (info->bits_per_pixel / 8u);
+	line_stride = (line_px_data_len + 3u) & ~(uint64_t)0x03u;
+	band_rows = config->is_whole_image ? (uint32_t)info->height : (config->band_buf_pixels / info->width);
+
+	if ((line_stride > ((uint64_t)config->line_buf_words * sizeof(uint32_t))) || (band_rows == 0u) ||
+		(config->is_whole_image && ((uint64_t)config->band_buf_pixels < ((uint64_t)info->width * (uint64_t)info->height))))
+	{
+		return BMPSTREAM_ERR_BUFFER;
+	}
+
+	/* Rows are read at 32-bit offsets. */
+	if (((uint64_t)info->data_offset + (line_stride * (uint64_t)info->height)) > UINT32_MAX)
+	{
+		return BMPSTREAM_ERR_FORMAT;
+	}
+
+	if (config->is_whole_image && (config->band_rows > 0))
+	{
+		/* The sink still gets the image in bands, so it can be shown while loading. */
+		band_rows = (uint32_t)config->band_rows;
+	}
+
+	band_rows = (band_rows > (uint32_t)info->height) ? (uint32_t)info->height : band_rows;
+
+	for (int y = 0; y < info->height; y += rows)
+	{
+		rows = ((info->height - y) < (int)band_rows) ? (info->height - y) : (int)band_rows;
+		band = config->is_whole_image ? (config->band_buf + ((uint32_t)y * info->width)) : config->band_buf;
+		dest_ptr = band;
+
+		for (int r = 0; r < rows; r++)
+		{
+			/* Bottom up files store the top row last. */
+			file_row = info->is_top_down ? (uint32_t)(y + r) : (uint32_t)(info->height - (y + r + 1));
+
+			if (config->read(config->read_ctx, info->data_offset + (file_row * (uint32_t)line_stride), config->line_buf, (uint32_t)line_stride) != 0)
+			{
+				return BMPSTREAM_ERR_READ;
+			}
+
+			if (info->bits_per_pixel == 24u)
+			{
+				colorConv_BGR888LineTo565((const uint8_t *)config->line_buf, dest_ptr, info->width);
+			}
+			else
+			{
+				colorConv_ARGB8888LineTo565(config->line_buf, dest_ptr, info->width);
+			}
+
+			dest_ptr += info->width;
+		}
+
+		if (config->format == BMPSTREAM_PIXELS_RGB565)
+		{
+			colorConv_swapBytes(band, rows * info->width);
+		}
+
+		if (config->sink != NULL)
+		{
+			config->sink(config->sink_ctx, y, rows, info->width, band);
+		}
+	}
+
+	return BMPSTREAM_OK;
+}
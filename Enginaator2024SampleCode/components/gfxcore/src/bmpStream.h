@@ -0,0 +1,85 @@
+/*
+ * bmpStream.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Banded BMP decoder. Reading the file and showing the pixels are done by callbacks, so the same
+ *  code runs in the ESP-IDF app, in the Arduino sketch and on a PC. The image is decoded one band
+ *  of rows at a time into a caller supplied buffer, so an image of any height can be shown while
+ *  holding only one band of it in RAM.
+ */
+
+#ifndef GFXCORE_BMPSTREAM_H_
+#define GFXCORE_BMPSTREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BMPSTREAM_OK			0
+#define BMPSTREAM_ERR_READ		(-1)	/* The read callback failed. */
+#define BMPSTREAM_ERR_FORMAT	(-2)	/* Not a 24 or 32 bit uncompressed bitmap. */
+#define BMPSTREAM_ERR_BUFFER	(-3)	/* The line or band buffer is too small for the image. */
+
+/* Line buffer size needed for images up to the given width, in 32-bit words (the buffer must be word aligned). */
+#define BMPSTREAM_LINE_BUFFER_WORDS(max_width) (max_width)
+
+typedef enum
+{
+	BMPSTREAM_PIXELS_DISPLAY,	/* Byte swapped RGB565, as sent over SPI by display.c */
+	BMPSTREAM_PIXELS_RGB565,	/* Normal RGB565, as used by Adafruit GFX and most other graphics libraries */
+} BmpStreamPixelFormat_T;
+
+/* Reads len bytes at offset of the file. Returns 0 on success. */
+typedef int (*BmpStream_Read_T)(void * ctx, uint32_t offset, void * buf, uint32_t len);
+
+/* Called with each decoded band. pixels holds number_of_rows rows of width pixels, top row first. */
+typedef void (*BmpStream_Sink_T)(void * ctx, int first_row, int number_of_rows, int width, uint16_t * pixels);
+
+typedef struct
+{
+	int32_t width;
+	int32_t height;
+	uint16_t bits_per_pixel;
+	uint32_t data_offset;
+	bool is_top_down;
+} BmpStreamInfo_T;
+
+typedef struct
+{
+	BmpStream_Read_T read;
+	void * read_ctx;
+
+	BmpStream_Sink_T sink;		/* Can be NULL when decoding into a whole image buffer. */
+	void * sink_ctx;
+
+	uint32_t * line_buf;		/* One line of the file */
+	uint32_t line_buf_words;
+
+	uint16_t * band_buf;
+	uint32_t band_buf_pixels;	/* The number of rows per band is band_buf_pixels / width */
+
+	/* If set, band_buf holds the whole image and each band is decoded in its own place in it,
+	 * band_rows rows at a time (0 for the whole image at once).
+	 * Otherwise every band is decoded to the start of band_buf. */
+	bool is_whole_image;
+	int band_rows;
+
+	BmpStreamPixelFormat_T format;
+} BmpStreamConfig_T;
+
+/* Reads and checks the headers. */
+extern int bmpStream_readInfo(BmpStream_Read_T read, void * read_ctx, BmpStreamInfo_T * info);
+
+/* Decodes the whole image, calling the sink after each band. info can be NULL. */
+extern int bmpStream_decode(const BmpStreamConfig_T * config, BmpStreamInfo_T * info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GFXCORE_BMPSTREAM_H_ */
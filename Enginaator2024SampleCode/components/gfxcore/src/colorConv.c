@@ -0,0 +1,165 @@
+/*
+ * colorConv.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "colorConv.h"
+
+/****************** Private defines *******************/
+
+/* Per channel parts of CONVERT_888RGB_TO_565RGB. OR-ing the three together gives the full color. */
+#define CONV_R(v) ((uint16_t)(((v) >> 3) << 3))
+#define CONV_G(v) ((uint16_t)(((v) >> 5) | ((((v) >> 2) & 0x7u) << 13)))
+#define CONV_B(v) ((uint16_t)(((v) >> 3) << 8))
+
+/* Expands to F(0), F(1) ... F(255), so the tables are filled in by the compiler. */
+#define REP4(F, n)   F(n), F((n) + 1), F((n) + 2), F((n) + 3)
+#define REP16(F, n)  REP4(F, n), REP4(F, (n) + 4), REP4(F, (n) + 8), REP4(F, (n) + 12)
+#define REP64(F, n)  REP16(F, n), REP16(F, (n) + 16), REP16(F, (n) + 32), REP16(F, (n) + 48)
+#define REP256(F)    REP64(F, 0), REP64(F, 64), REP64(F, 128), REP64(F, 192)
+
+/* Bytes of a little endian 32-bit word. */
+#define BYTE0(w) ((w) & 0xffu)
+#define BYTE1(w) (((w) >> 8) & 0xffu)
+#define BYTE2(w) (((w) >> 16) & 0xffu)
+#define BYTE3(w) ((w) >> 24)
+
+#define IS_WORD_ALIGNED(p) ((((uintptr_t)(p)) & 0x3u) == 0u)
+
+/**************** Private function forward declarations **************/
+
+static inline uint32_t priv_loadWord(const void * p);
+static inline void priv_storeWord(void * p, uint32_t w);
+
+/**************** Public variable declarations ******************/
+
+const uint16_t colorConv_R[256] = { REP256(CONV_R) };
+const uint16_t colorConv_G[256] = { REP256(CONV_G) };
+const uint16_t colorConv_B[256] = { REP256(CONV_B) };
+
+/**************** Public functions  **************/
+
+void colorConv_BGR888LineTo565(const uint8_t * src, uint16_t * dest, int count)
+{
+	/* Fast path : 4 pixels (3 source words, 2 destination words) per iteration. Needs both buffers word aligned. */
+	if (IS_WORD_ALIGNED(src) && IS_WORD_ALIGNED(dest))
+	{
+		while (count >= 4)
+		{
+			/* w0 = B0 G0 R0 B1, w1 = G1 R1 B2 G2, w2 = R2 B3 G3 R3 */
+			uint32_t w0 = priv_loadWord(src);
+			uint32_t w1 = priv_loadWord(src + 4);
+			uint32_t w2 = priv_loadWord(src + 8);
+
+			uint32_t p0 = colorConv_R[BYTE2(w0)] | colorConv_G[BYTE1(w0)] | colorConv_B[BYTE0(w0)];
+			uint32_t p1 = colorConv_R[BYTE1(w1)] | colorConv_G[BYTE0(w1)] | colorConv_B[BYTE3(w0)];
+			uint32_t p2 = colorConv_R[BYTE0(w2)] | colorConv_G[BYTE3(w1)] | colorConv_B[BYTE2(w1)];
+			uint32_t p3 = colorConv_R[BYTE3(w2)] | colorConv_G[BYTE2(w2)] | colorConv_B[BYTE1(w2)];
+
+			priv_storeWord(dest, p0 | (p1 << 16));
+			priv_storeWord(dest + 2, p2 | (p3 << 16));
+
+			src += 12;
+			dest += 4;
+			count -= 4;
+		}
+	}
+
+	/* Remaining (or unaligned) pixels one at a time. */
+	while (count > 0)
+	{
+		*dest++ = colorConv_R[src[2]] | colorConv_G[src[1]] | colorConv_B[src[0]];
+		src += 3;
+		count--;
+	}
+}
+
+
+void colorConv_ARGB8888LineTo565(const uint32_t * src, uint16_t * dest, int count)
+{
+	uint32_t px;
+
+	if (IS_WORD_ALIGNED(dest))
+	{
+		while (count >= 2)
+		{
+			uint32_t px1;
+
+			px = src[0];
+			px1 = src[1];
+
+			priv_storeWord(dest, (uint32_t)(colorConv_R[BYTE2(px)]  | colorConv_G[BYTE1(px)]  | colorConv_B[BYTE0(px)]) |
+								((uint32_t)(colorConv_R[BYTE2(px1)] | colorConv_G[BYTE1(px1)] | colorConv_B[BYTE0(px1)]) << 16));
+
+			src += 2;
+			dest += 2;
+			count -= 2;
+		}
+	}
+
+	while (count > 0)
+	{
+		px = *src++;
+		*dest++ = colorConv_R[BYTE2(px)] | colorConv_G[BYTE1(px)] | colorConv_B[BYTE0(px)];
+		count--;
+	}
+}
+
+
+void colorConv_565LineToBGR888(const uint16_t * src, uint8_t * dest, int count)
+{
+	uint16_t c;
+	uint8_t r5, g6, b5;
+
+	while (count > 0)
+	{
+		/* Undo the byte swap to get a normal RGB565 value. */
+		c = (uint16_t)((*src >> 8) | (*src << 8));
+
+		r5 = c >> 11;
+		g6 = (c >> 5) & 0x3fu;
+		b5 = c & 0x1fu;
+
+		dest[0] = (b5 << 3) | (b5 >> 2);
+		dest[1] = (g6 << 2) | (g6 >> 4);
+		dest[2] = (r5 << 3) | (r5 >> 2);
+
+		src++;
+		dest += 3;
+		count--;
+	}
+}
+
+
+void colorConv_swapBytes(uint16_t * buf, int count)
+{
+	while (count > 0)
+	{
+		*buf = (uint16_t)((*buf >> 8) | (*buf << 8));
+		buf++;
+		count--;
+	}
+}
+
+/*********** Private functions ***********/
+
+/* Word access to byte and halfword buffers goes through memcpy, which keeps it within the aliasing rules. The callers
+ * only use these on word aligned pointers, so the compiler can still make each one a single 32-bit load or store. */
+static inline uint32_t priv_loadWord(const void * p)
+{
+	uint32_t w;
+
+	memcpy(&w, __builtin_assume_aligned(p, 4), sizeof(w));
+	return w;
+}
+
+
+static inline void priv_storeWord(void * p, uint32_t w)
+{
+	memcpy(__builtin_assume_aligned(p, 4), &w, sizeof(w));
+}
@@ -0,0 +1,49 @@
+/*
+ * colorConv.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Pixel format conversion. All 16-bit output is in the byte swapped RGB565
+ *  format expected by the display, i.e. the same values that CONVERT_888RGB_TO_565RGB produces.
+ *  The line functions process a whole scanline per call, so the per pixel overhead of
+ *  the call and the loop control is amortized over the line.
+ */
+
+#ifndef GFXCORE_COLORCONV_H_
+#define GFXCORE_COLORCONV_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Lookup tables, generated at compile time. The converted color is simply colorConv_R[r] | colorConv_G[g] | colorConv_B[b] */
+extern const uint16_t colorConv_R[256];
+extern const uint16_t colorConv_G[256];
+extern const uint16_t colorConv_B[256];
+
+/* Converts a single 888 color. Gives the same result as CONVERT_888RGB_TO_565RGB, but can be used with non-constant arguments. */
+static inline uint16_t colorConv_888To565(uint8_t r, uint8_t g, uint8_t b)
+{
+	return colorConv_R[r] | colorConv_G[g] | colorConv_B[b];
+}
+
+/* BMP line data (B, G, R byte order) to display format. */
+void colorConv_BGR888LineTo565(const uint8_t * src, uint16_t * dest, int count);
+
+/* 32-bit ARGB pixels (B, G, R, A byte order in memory, as in 32bpp BMP files) to display format. Alpha is ignored. */
+void colorConv_ARGB8888LineTo565(const uint32_t * src, uint16_t * dest, int count);
+
+/* Display format back to B, G, R byte order. Used when writing out screenshots. Low bits are filled by bit replication, so white stays white. */
+void colorConv_565LineToBGR888(const uint16_t * src, uint8_t * dest, int count);
+
+/* Swaps the bytes of each pixel, between the display format and normal RGB565 as used by most graphics libraries. */
+void colorConv_swapBytes(uint16_t * buf, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GFXCORE_COLORCONV_H_ */
@@ -0,0 +1,17 @@
+/*
+ * gfxcore.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Platform independent graphics code, shared by the ESP-IDF app (as a component) and the
+ *  Arduino sketches (as a library). Nothing in here depends on ESP-IDF, Arduino or a display driver.
+ */
+
+#ifndef GFXCORE_GFXCORE_H_
+#define GFXCORE_GFXCORE_H_
+
+#include "colorConv.h"
+#include "bmpStream.h"
+
+#endif /* GFXCORE_GFXCORE_H_ */
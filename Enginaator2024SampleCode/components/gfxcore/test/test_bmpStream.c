@@ -0,0 +1,458 @@
+/*
+ * test_bmpStream.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Decodes every bitmap in the given directory (the SD Card directory of the repository) as a whole
+ *  image and in bands of several heights, and checks that all of them give the same pixels as a
+ *  simple pixel by pixel reference decoder. Each file is also converted to a 32-bit top down bitmap
+ *  in memory, so the other row order and pixel size are covered too. Last, a few headers with sizes
+ *  that overflow 32 bits must be refused.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+
+#include "bmpStream.h"
+#include "colorConv.h"
+
+/* Same as in main/display.h, which cannot be included on the host. */
+#define CONVERT_888RGB_TO_565RGB(r, g, b) (((r >> 3) << 3) | (g >> 5) | (((g >> 2) & 0x7u) << 13) | ((b >> 3) << 8))
+
+#define BMP_HEADER_SIZE 54u
+
+typedef struct
+{
+	const uint8_t * data;
+	uint32_t size;
+} MemFile_T;
+
+typedef struct
+{
+	uint16_t * image;
+	int width;
+	int next_row;
+	int max_band_rows;
+	int errors;
+} BandSink_T;
+
+static int priv_errors = 0;
+
+
+static uint32_t priv_get32(const uint8_t * p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+static void priv_put32(uint8_t * p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+
+static int priv_memRead(void * ctx, uint32_t offset, void * buf, uint32_t len)
+{
+	MemFile_T * file = (MemFile_T *)ctx;
+
+	if ((offset > file->size) || (len > (file->size - offset)))
+	{
+		return -1;
+	}
+
+	memcpy(buf, file->data + offset, len);
+	return 0;
+}
+
+
+static void priv_bandSink(void * ctx, int first_row, int number_of_rows, int width, uint16_t * pixels)
+{
+	BandSink_T * sink = (BandSink_T *)ctx;
+
+	/* Bands must come in order, top to bottom, and never be larger than asked for. */
+	if ((first_row != sink->next_row) || (number_of_rows > sink->max_band_rows) || (width != sink->width))
+	{
+		sink->errors++;
+		return;
+	}
+
+	memcpy(sink->image + (first_row * width), pixels, (size_t)number_of_rows * width * sizeof(uint16_t));
+	sink->next_row += number_of_rows;
+}
+
+
+/* Straightforward decoder for 24 and 32 bit files, one pixel at a time. */
+static void priv_referenceDecode(const MemFile_T * file, uint16_t * image)
+{
+	uint32_t offset = priv_get32(file->data + 10);
+	int width = (int)priv_get32(file->data + 18);
+	int height = (int)priv_get32(file->data + 22);
+	int bytes_pp = file->data[28] / 8;
+	int is_top_down = (height < 0);
+	uint32_t stride;
+	const uint8_t * px;
+
+	height = is_top_down ? -height : height;
+	stride = ((uint32_t)(width * bytes_pp) + 3u) & ~3u;
+
+	for (int y = 0; y < height; y++)
+	{
+		int file_row = is_top_down ? y : (height - 1 - y);
+
+		for (int x = 0; x < width; x++)
+		{
+			px = file->data + offset + (file_row * stride) + (x * bytes_pp);
+			image[(y * width) + x] = (uint16_t)CONVERT_888RGB_TO_565RGB(px[2], px[1], px[0]);
+		}
+	}
+}
+
+
+/* The same image as a 32-bit top down bitmap with a junk alpha channel. */
+static uint8_t * priv_make32BitTopDown(const MemFile_T * file, uint32_t * size)
+{
+	uint32_t offset = priv_get32(file->data + 10);
+	int width = (int)priv_get32(file->data + 18);
+	int height = (int)priv_get32(file->data + 22);
+	uint32_t stride = ((uint32_t)(width * 3) + 3u) & ~3u;
+	uint8_t * out;
+	uint8_t * dest;
+	const uint8_t * src;
+
+	*size = BMP_HEADER_SIZE + ((uint32_t)width * height * 4u);
+	out = malloc(*size);
+
+	memcpy(out, file->data, BMP_HEADER_SIZE);
+	priv_put32(out + 2, *size);
+	priv_put32(out + 10, BMP_HEADER_SIZE);
+	priv_put32(out + 22, (uint32_t)(-height));
+	out[28] = 32;
+
+	for (int y = 0; y < height; y++)
+	{
+		src = file->data + offset + ((uint32_t)(height - 1 - y) * stride);
+		dest = out + BMP_HEADER_SIZE + ((uint32_t)y * width * 4u);
+
+		for (int x = 0; x < width; x++)
+		{
+			dest[(x * 4) + 0] = src[(x * 3) + 0];
+			dest[(x * 4) + 1] = src[(x * 3) + 1];
+			dest[(x * 4) + 2] = src[(x * 3) + 2];
+			dest[(x * 4) + 3] = (uint8_t)(x * 7);
+		}
+	}
+
+	return out;
+}
+
+
+static void priv_compare(const char * name, const char * mode, const uint16_t * result, const uint16_t * expected, int count)
+{
+	for (int ix = 0; ix < count; ix++)
+	{
+		if (result[ix] != expected[ix])
+		{
+			printf("%s %s : pixel %d is %04x, expected %04x\n", name, mode, ix, result[ix], expected[ix]);
+			priv_errors++;
+			return;
+		}
+	}
+}
+
+
+static void priv_testFile(const char * name, const MemFile_T * file)
+{
+	static const int band_heights[] = { 1, 7, 16, 1000 };
+
+	BmpStreamInfo_T info;
+	BmpStreamConfig_T config;
+	BandSink_T sink;
+	uint16_t * expected;
+	uint16_t * image;
+	uint16_t * band;
+	uint32_t * line;
+	int pixels;
+	int res;
+
+	res = bmpStream_readInfo(priv_memRead, (void *)file, &info);
+	if (res != BMPSTREAM_OK)
+	{
+		printf("%s : readInfo failed with %d\n", name, res);
+		priv_errors++;
+		return;
+	}
+
+	pixels = info.width * info.height;
+	expected = malloc(pixels * sizeof(uint16_t));
+	image = malloc(pixels * sizeof(uint16_t));
+	line = malloc(BMPSTREAM_LINE_BUFFER_WORDS(info.width) * sizeof(uint32_t));
+	priv_referenceDecode(file, expected);
+
+	memset(&config, 0, sizeof(config));
+	config.read = priv_memRead;
+	config.read_ctx = (void *)file;
+	config.line_buf = line;
+	config.line_buf_words = BMPSTREAM_LINE_BUFFER_WORDS(info.width);
+	config.format = BMPSTREAM_PIXELS_DISPLAY;
+
+	/* Whole image at once, as read_bmp_file does. */
+	memset(image, 0, pixels * sizeof(uint16_t));
+	config.band_buf = image;
+	config.band_buf_pixels = pixels;
+	config.is_whole_image = true;
+	res = bmpStream_decode(&config, NULL);
+	if (res != BMPSTREAM_OK)
+	{
+		printf("%s whole : decode failed with %d\n", name, res);
+		priv_errors++;
+	}
+	priv_compare(name, "whole", image, expected, pixels);
+
+	/* Whole image, shown in bands while it loads. */
+	for (unsigned h = 0; h < (sizeof(band_heights) / sizeof(band_heights[0])); h++)
+	{
+		memset(image, 0, pixels * sizeof(uint16_t));
+		config.band_rows = band_heights[h];
+		config.sink = NULL;
+		res = bmpStream_decode(&config, NULL);
+		if (res != BMPSTREAM_OK)
+		{
+			printf("%s whole, %d row bands : decode failed with %d\n", name, band_heights[h], res);
+			priv_errors++;
+		}
+		priv_compare(name, "whole in bands", image, expected, pixels);
+	}
+
+	/* Banded into a small buffer, each band copied out by the sink. */
+	for (unsigned h = 0; h < (sizeof(band_heights) / sizeof(band_heights[0])); h++)
+	{
+		band = malloc((size_t)band_heights[h] * info.width * sizeof(uint16_t));
+		memset(image, 0, pixels * sizeof(uint16_t));
+
+		sink.image = image;
+		sink.width = info.width;
+		sink.next_row = 0;
+		sink.max_band_rows = band_heights[h];
+		sink.errors = 0;
+
+		config.is_whole_image = false;
+		config.band_rows = 0;
+		config.band_buf = band;
+		config.band_buf_pixels = (uint32_t)band_heights[h] * info.width;
+		config.sink = priv_bandSink;
+		config.sink_ctx = &sink;
+
+		res = bmpStream_decode(&config, NULL);
+		if ((res != BMPSTREAM_OK) || (sink.errors > 0) || (sink.next_row != info.height))
+		{
+			printf("%s %d row bands : decode returned %d, %d bad bands, %d of %d rows\n",
+					name, band_heights[h], res, sink.errors, sink.next_row, (int)info.height);
+			priv_errors++;
+		}
+		priv_compare(name, "banded", image, expected, pixels);
+
+		/* The same bands in normal RGB565 are the byte swapped display pixels. */
+		sink.next_row = 0;
+		config.format = BMPSTREAM_PIXELS_RGB565;
+		res = bmpStream_decode(&config, NULL);
+		config.format = BMPSTREAM_PIXELS_DISPLAY;
+		colorConv_swapBytes(image, pixels);
+		if (res != BMPSTREAM_OK)
+		{
+			printf("%s %d row bands RGB565 : decode failed with %d\n", name, band_heights[h], res);
+			priv_errors++;
+		}
+		priv_compare(name, "banded RGB565", image, expected, pixels);
+
+		free(band);
+	}
+
+	/* A band buffer smaller than one row must be refused, not overrun. */
+	band = malloc(sizeof(uint16_t));
+	config.band_buf = band;
+	config.band_buf_pixels = (uint32_t)info.width - 1u;
+	if (bmpStream_decode(&config, NULL) != BMPSTREAM_ERR_BUFFER)
+	{
+		printf("%s : too small band buffer was accepted\n", name);
+		priv_errors++;
+	}
+	free(band);
+
+	free(line);
+	free(image);
+	free(expected);
+}
+
+
+/* Headers whose sizes overflow 32 bits must be refused before anything is read into the buffers. */
+static void priv_testMalformed(void)
+{
+	static const struct
+	{
+		const char * name;
+		uint32_t width;
+		uint32_t height;
+		int expected;
+	} cases[] =
+	{
+		{ "width * 4 wraps to 4 bytes", 0x40000001u, 4u, BMPSTREAM_ERR_BUFFER },
+		{ "width * height wraps to 4 pixels", 0x40000001u, 0x40000004u, BMPSTREAM_ERR_BUFFER },
+		{ "height of INT32_MIN", 4u, 0x80000000u, BMPSTREAM_ERR_FORMAT },
+	};
+
+	uint8_t header[BMP_HEADER_SIZE];
+	uint32_t line[16];
+	uint16_t band[64];
+	BmpStreamConfig_T config;
+	MemFile_T file;
+	int res;
+
+	for (unsigned c = 0; c < (sizeof(cases) / sizeof(cases[0])); c++)
+	{
+		memset(header, 0, sizeof(header));
+		header[0] = 'B';
+		header[1] = 'M';
+		priv_put32(header + 2, BMP_HEADER_SIZE);
+		priv_put32(header + 10, BMP_HEADER_SIZE);
+		priv_put32(header + 14, 40u);
+		priv_put32(header + 18, cases[c].width);
+		priv_put32(header + 22, cases[c].height);
+		header[26] = 1;
+		header[28] = 32;
+
+		file.data = header;
+		file.size = sizeof(header);
+
+		memset(&config, 0, sizeof(config));
+		config.read = priv_memRead;
+		config.read_ctx = &file;
+		config.line_buf = line;
+		config.line_buf_words = sizeof(line) / sizeof(line[0]);
+		config.band_buf = band;
+		config.band_buf_pixels = sizeof(band) / sizeof(band[0]);
+		config.format = BMPSTREAM_PIXELS_DISPLAY;
+
+		for (int whole = 0; whole < 2; whole++)
+		{
+			config.is_whole_image = (whole != 0);
+			res = bmpStream_decode(&config, NULL);
+			if (res != cases[c].expected)
+			{
+				printf("malformed header, %s%s : decode returned %d, expected %d\n",
+						cases[c].name, config.is_whole_image ? ", whole" : "", res, cases[c].expected);
+				priv_errors++;
+			}
+		}
+	}
+}
+
+
+static int priv_loadFile(const char * path, MemFile_T * file)
+{
+	FILE * f = fopen(path, "rb");
+	long size;
+	uint8_t * data;
+
+	if (f == NULL)
+	{
+		return -1;
+	}
+
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	data = malloc(size);
+	if (fread(data, 1, size, f) != (size_t)size)
+	{
+		free(data);
+		fclose(f);
+		return -1;
+	}
+
+	fclose(f);
+	file->data = data;
+	file->size = (uint32_t)size;
+	return 0;
+}
+
+
+int main(int argc, char ** argv)
+{
+	char path[512];
+	char name[300];
+	struct dirent * entry;
+	MemFile_T file;
+	MemFile_T file32;
+	uint8_t * data32;
+	size_t len;
+	int files = 0;
+	DIR * dir;
+
+	if (argc != 2)
+	{
+		printf("Usage: test_bmpStream <directory of bmp files>\n");
+		return 1;
+	}
+
+	dir = opendir(argv[1]);
+	if (dir == NULL)
+	{
+		printf("Cannot open %s\n", argv[1]);
+		return 1;
+	}
+
+	while ((entry = readdir(dir)) != NULL)
+	{
+		len = strlen(entry->d_name);
+		if ((len < 5) || (strcmp(entry->d_name + len - 4, ".bmp") != 0))
+		{
+			continue;
+		}
+
+		snprintf(path, sizeof(path), "%s/%s", argv[1], entry->d_name);
+		if (priv_loadFile(path, &file) != 0)
+		{
+			printf("Cannot read %s\n", path);
+			priv_errors++;
+			continue;
+		}
+
+		priv_testFile(entry->d_name, &file);
+
+		data32 = priv_make32BitTopDown(&file, &file32.size);
+		file32.data = data32;
+		snprintf(name, sizeof(name), "%s (32-bit top down)", entry->d_name);
+		priv_testFile(name, &file32);
+
+		free(data32);
+		free((void *)file.data);
+		files++;
+	}
+
+	closedir(dir);
+
+	priv_testMalformed();
+
+	if (files == 0)
+	{
+		printf("No bmp files in %s\n", argv[1]);
+		return 1;
+	}
+
+	if (priv_errors > 0)
+	{
+		printf("bmpStream : %d errors\n", priv_errors);
+		return 1;
+	}
+
+	printf("bmpStream : %d files ok\n", files);
+	return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * test_colorConv.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Checks the line converters against CONVERT_888RGB_TO_565RGB for every 24-bit color,
+ *  on both the word aligned fast path and the pixel by pixel path.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "colorConv.h"
+
+/* Same as in main/display.h, which cannot be included on the host. */
+#define CONVERT_888RGB_TO_565RGB(r, g, b) (((r >> 3) << 3) | (g >> 5) | (((g >> 2) & 0x7u) << 13) | ((b >> 3) << 8))
+
+/* One line holds all blue values for one red and green. */
+#define LINE_PIXELS 256
+
+static uint32_t priv_src_words[LINE_PIXELS + 1];
+static uint32_t priv_dest_words[LINE_PIXELS / 2 + 1];
+static uint16_t priv_expected[LINE_PIXELS];
+
+static int priv_errors = 0;
+
+
+static void priv_check(const char * name, const uint16_t * result, int r, int g)
+{
+	for (int b = 0; b < LINE_PIXELS; b++)
+	{
+		if (result[b] != priv_expected[b])
+		{
+			if (priv_errors < 10)
+			{
+				printf("%s : (%d, %d, %d) gives %04x, expected %04x\n", name, r, g, b, result[b], priv_expected[b]);
+			}
+			priv_errors++;
+		}
+	}
+}
+
+
+static void priv_testBGR888(int offset)
+{
+	uint8_t * src = (uint8_t *)priv_src_words + (offset * 3);
+	uint16_t * dest = (uint16_t *)priv_dest_words + offset;
+	const char * name = offset ? "BGR888 unaligned" : "BGR888 aligned";
+
+	for (int r = 0; r < 256; r++)
+	{
+		for (int g = 0; g < 256; g++)
+		{
+			for (int b = 0; b < LINE_PIXELS; b++)
+			{
+				src[(b * 3) + 0] = (uint8_t)b;
+				src[(b * 3) + 1] = (uint8_t)g;
+				src[(b * 3) + 2] = (uint8_t)r;
+				priv_expected[b] = (uint16_t)CONVERT_888RGB_TO_565RGB(r, g, b);
+			}
+
+			colorConv_BGR888LineTo565(src, dest, LINE_PIXELS);
+			priv_check(name, dest, r, g);
+		}
+	}
+}
+
+
+static void priv_testARGB8888(int offset)
+{
+	uint32_t * src = priv_src_words;
+	uint16_t * dest = (uint16_t *)priv_dest_words + offset;
+	const char * name = offset ? "ARGB8888 unaligned" : "ARGB8888 aligned";
+
+	for (int r = 0; r < 256; r++)
+	{
+		for (int g = 0; g < 256; g++)
+		{
+			for (int b = 0; b < LINE_PIXELS; b++)
+			{
+				/* Alpha must be ignored, so fill it with something. */
+				src[b] = ((uint32_t)(r ^ b) << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+				priv_expected[b] = (uint16_t)CONVERT_888RGB_TO_565RGB(r, g, b);
+			}
+
+			colorConv_ARGB8888LineTo565(src, dest, LINE_PIXELS);
+			priv_check(name, dest, r, g);
+		}
+	}
+}
+
+
+/* Odd lengths end on the pixel by pixel tail of the fast path. */
+static void priv_testTails(void)
+{
+	uint8_t src[3 * 7];
+	uint32_t dest_words[4];
+	uint16_t * dest = (uint16_t *)dest_words;
+
+	for (int count = 1; count <= 7; count++)
+	{
+		for (int ix = 0; ix < (3 * count); ix++)
+		{
+			src[ix] = (uint8_t)(37 * ix + count);
+		}
+
+		memset(dest_words, 0xa5, sizeof(dest_words));
+		colorConv_BGR888LineTo565(src, dest, count);
+
+		for (int ix = 0; ix < 8; ix++)
+		{
+			uint16_t expected = (ix < count) ? (uint16_t)CONVERT_888RGB_TO_565RGB(src[(ix * 3) + 2], src[(ix * 3) + 1], src[ix * 3]) : 0xa5a5u;
+			if (dest[ix] != expected)
+			{
+				printf("BGR888 tail : count %d pixel %d gives %04x, expected %04x\n", count, ix, dest[ix], expected);
+				priv_errors++;
+			}
+		}
+	}
+}
+
+
+/* 565 -> 888 -> 565 must give back the same color for every 16-bit value, and white must stay white. */
+static void priv_testRoundTrip(void)
+{
+	uint16_t px;
+	uint16_t back;
+	uint8_t bgr[3];
+
+	for (uint32_t c = 0; c < 0x10000u; c++)
+	{
+		px = (uint16_t)c;
+		colorConv_565LineToBGR888(&px, bgr, 1);
+		colorConv_BGR888LineTo565(bgr, &back, 1);
+
+		if (back != px)
+		{
+			printf("Round trip : %04x gives %04x\n", px, back);
+			priv_errors++;
+		}
+	}
+
+	px = 0xffffu;
+	colorConv_565LineToBGR888(&px, bgr, 1);
+	if ((bgr[0] != 0xffu) || (bgr[1] != 0xffu) || (bgr[2] != 0xffu))
+	{
+		printf("Round trip : white gives %02x %02x %02x\n", bgr[2], bgr[1], bgr[0]);
+		priv_errors++;
+	}
+}
+
+
+int main(void)
+{
+	priv_testBGR888(0);
+	priv_testBGR888(1);
+	priv_testARGB8888(0);
+	priv_testARGB8888(1);
+	priv_testTails();
+	priv_testRoundTrip();
+
+	if (priv_errors > 0)
+	{
+		printf("colorConv : %d errors\n", priv_errors);
+		return 1;
+	}
+
+	printf("colorConv : all 2^24 colors ok\n");
+	return 0;
+}
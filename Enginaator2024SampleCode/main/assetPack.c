@@ -0,0 +1,140 @@
+/*
+ * assetPack.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+
+#include "assetPack.h"
+
+/****************** Private defines *******************/
+
+#define ASSET_PACK_MAGIC 	0x4B415045u  /* "EPAK" */
+#define ASSET_PACK_VERSION 	1u
+
+#define ASSET_PACK_MAX_ENTRIES 64u
+
+/****************** Private type definitions *******************/
+
+#pragma pack(push)
+#pragma pack(1)
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t entry_count;
+	uint32_t data_start;
+	uint32_t reserved;
+} AssetPackHeader_T;
+#pragma pack(pop)
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Asset Pack";
+
+static int priv_fd = -1;
+static uint16_t priv_entry_count = 0u;
+static AssetPackEntry_T priv_entries[ASSET_PACK_MAX_ENTRIES];
+
+/**************** Public functions  **************/
+
+esp_err_t assetPack_open(const char * path)
+{
+	AssetPackHeader_T header;
+	ssize_t toc_size;
+
+	priv_fd = open(path, O_RDONLY);
+
+	if (priv_fd < 0)
+	{
+		ESP_LOGI(TAG, "No asset pack at %s, assets are loaded from single files", path);
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	if ((read(priv_fd, &header, sizeof(header)) != sizeof(header)) || (header.magic != ASSET_PACK_MAGIC) || (header.version != ASSET_PACK_VERSION))
+	{
+		ESP_LOGE(TAG, "%s is not a valid asset pack", path);
+		close(priv_fd);
+		priv_fd = -1;
+		return ESP_FAIL;
+	}
+
+	if (header.entry_count > ASSET_PACK_MAX_ENTRIES)
+	{
+		ESP_LOGE(TAG, "Asset pack has %d entries, only %d supported", header.entry_count, ASSET_PACK_MAX_ENTRIES);
+		close(priv_fd);
+		priv_fd = -1;
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	/* The table of contents follows the header. */
+	toc_size = header.entry_count * sizeof(AssetPackEntry_T);
+
+	if (read(priv_fd, priv_entries, toc_size) != toc_size)
+	{
+		ESP_LOGE(TAG, "Failed to read the asset pack table of contents");
+		close(priv_fd);
+		priv_fd = -1;
+		return ESP_FAIL;
+	}
+
+	for (int x = 0; x < header.entry_count; x++)
+	{
+		/* Do not trust the file to terminate the names. */
+		priv_entries[x].name[ASSET_PACK_NAME_LENGTH - 1u] = '\0';
+	}
+
+	priv_entry_count = header.entry_count;
+	ESP_LOGI(TAG, "Opened %s, %d assets", path, priv_entry_count);
+
+	return ESP_OK;
+}
+
+
+bool assetPack_isOpen(void)
+{
+	return (priv_fd >= 0);
+}
+
+
+const AssetPackEntry_T * assetPack_find(const char * name)
+{
+	if (name[0] == '/')
+	{
+		name++;
+	}
+
+	for (int x = 0; x < priv_entry_count; x++)
+	{
+		if (strcmp(priv_entries[x].name, name) == 0)
+		{
+			return &priv_entries[x];
+		}
+	}
+
+	return NULL;
+}
+
+
+esp_err_t assetPack_read(const AssetPackEntry_T * entry, uint32_t offset, void * buf, uint32_t len)
+{
+	if ((offset > entry->size) || (len > (entry->size - offset)))
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	/* pread does not move a shared file position, so no locking is needed. */
+	if (pread(priv_fd, buf, len, entry->offset + offset) != (ssize_t)len)
+	{
+		ESP_LOGE(TAG, "Failed to read %s", entry->name);
+		return ESP_FAIL;
+	}
+
+	return ESP_OK;
+}
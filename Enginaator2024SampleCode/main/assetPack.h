@@ -0,0 +1,55 @@
+/*
+ * assetPack.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Single file asset archive on the SD card, built by tools/pack_assets.py. The file is opened once
+ *  and its table of contents is kept in RAM, so loading an asset is a lookup and an offset read
+ *  instead of a directory walk, open and close per asset. Entries start on sector boundaries.
+ */
+
+#ifndef MAIN_ASSETPACK_H_
+#define MAIN_ASSETPACK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+#define ASSET_PACK_NAME_LENGTH 32u
+
+typedef enum
+{
+	ASSET_FORMAT_RAW,		/* Stored as is. */
+	ASSET_FORMAT_BMP,		/* Bitmap file as is. */
+	ASSET_FORMAT_RGB565,	/* Top down pixels, already in the display format. */
+} AssetFormat_T;
+
+#pragma pack(push)
+#pragma pack(1)
+/* Layout matches the table of contents in the file. */
+typedef struct
+{
+	char name[ASSET_PACK_NAME_LENGTH];
+	uint32_t offset;
+	uint32_t size;
+	uint16_t format;
+	uint16_t width;
+	uint16_t height;
+	uint16_t reserved;
+} AssetPackEntry_T;
+#pragma pack(pop)
+
+/* Opens the pack and reads its table of contents. Returns an error if there is no valid pack at path. */
+extern esp_err_t assetPack_open(const char * path);
+
+extern bool assetPack_isOpen(void);
+
+/* Finds an asset by file name, with or without a leading '/'. Returns NULL if it is not in the pack. */
+extern const AssetPackEntry_T * assetPack_find(const char * name);
+
+/* Reads len bytes starting at offset within the asset. Can be called from several tasks. */
+extern esp_err_t assetPack_read(const AssetPackEntry_T * entry, uint32_t offset, void * buf, uint32_t len);
+
+#endif /* MAIN_ASSETPACK_H_ */
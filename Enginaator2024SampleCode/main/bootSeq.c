@@ -0,0 +1,104 @@
+/*
+ * bootSeq.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "bootSeq.h"
+
+/****************** Private defines *******************/
+
+#define BOOT_TASK_STACK_SIZE 	4096u
+#define BOOT_TASK_PRIORITY 		5u
+
+/**************** Private function forward declarations **************/
+
+static void bootStepTask(void * param);
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Boot";
+
+static EventGroupHandle_t priv_done_events;
+static const BootStep_T * priv_steps;
+
+static bool priv_isFirstFrameShown = false;
+static bool priv_isInteractive = false;
+
+/**************** Public functions  **************/
+
+void bootSeq_run(const BootStep_T * steps, uint8_t number_of_steps)
+{
+	uint32_t all_steps = (1u << number_of_steps) - 1u;
+	int64_t start_us = esp_timer_get_time();
+
+	assert(number_of_steps <= BOOT_MAX_STEPS);
+
+	priv_steps = steps;
+	priv_done_events = xEventGroupCreate();
+	assert(priv_done_events);
+
+	for (uintptr_t ix = 0u; ix < number_of_steps; ix++)
+	{
+		BaseType_t res = xTaskCreate(bootStepTask, steps[ix].name, BOOT_TASK_STACK_SIZE, (void *)ix, BOOT_TASK_PRIORITY, NULL);
+		assert(res == pdPASS);
+	}
+
+	xEventGroupWaitBits(priv_done_events, all_steps, pdFALSE, pdTRUE, portMAX_DELAY);
+
+	ESP_LOGI(TAG, "All %d boot steps done in %lld ms", number_of_steps, (long long)((esp_timer_get_time() - start_us) / 1000));
+}
+
+
+void bootSeq_markFirstFrame(void)
+{
+	if (!priv_isFirstFrameShown)
+	{
+		priv_isFirstFrameShown = true;
+		ESP_LOGI(TAG, "Time to first frame : %lld ms", (long long)(esp_timer_get_time() / 1000));
+	}
+}
+
+
+void bootSeq_markInteractive(void)
+{
+	if (!priv_isInteractive)
+	{
+		priv_isInteractive = true;
+		ESP_LOGI(TAG, "Time to interactive : %lld ms", (long long)(esp_timer_get_time() / 1000));
+	}
+}
+
+/*********** Private functions ***********/
+
+static void bootStepTask(void * param)
+{
+	uintptr_t ix = (uintptr_t)param;
+	const BootStep_T * step = &priv_steps[ix];
+	int64_t start_us;
+
+	if (step->depends != 0u)
+	{
+		xEventGroupWaitBits(priv_done_events, step->depends, pdFALSE, pdTRUE, portMAX_DELAY);
+	}
+
+	start_us = esp_timer_get_time();
+	step->func();
+
+	ESP_LOGI(TAG, "Step %s done in %lld ms, at %lld ms",
+			step->name,
+			(long long)((esp_timer_get_time() - start_us) / 1000),
+			(long long)(esp_timer_get_time() / 1000));
+
+	xEventGroupSetBits(priv_done_events, BOOT_STEP_BIT(ix));
+	vTaskDelete(NULL);
+}
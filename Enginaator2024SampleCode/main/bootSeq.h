@@ -0,0 +1,38 @@
+/*
+ * bootSeq.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Boot sequencer. Each initialization step runs in its own task as soon as the steps it depends
+ *  on are done, so slow steps that mostly wait (panel reset, SD mount) overlap. Also reports
+ *  time to first frame and time to interactive.
+ */
+
+#ifndef MAIN_BOOTSEQ_H_
+#define MAIN_BOOTSEQ_H_
+
+#include <stdint.h>
+
+#define BOOT_STEP_BIT(ix) (1u << (ix))
+
+/* Maximum number of steps in one sequence. */
+#define BOOT_MAX_STEPS 16u
+
+typedef void (*BootStepFunc_T)(void);
+
+typedef struct
+{
+	const char * name;
+	BootStepFunc_T func;
+	uint32_t depends;		/* BOOT_STEP_BIT() of each step that must be finished first. */
+} BootStep_T;
+
+/* Runs all steps and returns when every one of them has finished. */
+extern void bootSeq_run(const BootStep_T * steps, uint8_t number_of_steps);
+
+/* Called when the first image reaches the display and when the game loop has shown its first frame. */
+extern void bootSeq_markFirstFrame(void);
+extern void bootSeq_markInteractive(void);
+
+#endif /* MAIN_BOOTSEQ_H_ */
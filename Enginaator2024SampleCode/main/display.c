@@ -11,11 +11,17 @@
 #include <inttypes.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
 
 #include "display.h"
+#include "memPool.h"
+#include "trace.h"
+#include "teSync.h"
 
 #define LCD_HOST    SPI2_HOST
 
@@ -24,6 +30,44 @@
 #define PIN_NUM_CS         4
 #define PIN_NUM_BCKL       2
 
+/* ST7789 timing : reset pulse of at least 10us, 5ms before the first command after reset,
+ * 120ms between reset and Sleep Out, 5ms after Sleep Out before the next command. */
+#define LCD_RESET_PULSE_US              20u
+#define LCD_RESET_TO_CMD_MS             5u
+#define LCD_RESET_TO_SLEEP_OUT_MS       120u
+#define LCD_SLEEP_OUT_DELAY_MS          5u
+
+#define LCD_CMD_SLEEP_OUT               0x11u
+
+/* Bits of the transaction user field. */
+#define LCD_USER_DC                     1u      /* Level of the D/C line */
+#define LCD_USER_FLUSH_END              2u      /* Last transaction of a flush */
+
+/* Completion times are kept for this many of the latest flushes. Must be a power of two. */
+#define FLUSH_DONE_HISTORY              8u
+
+/* Address and memory write commands, followed by the pixel data in chunks. */
+#define DISPLAY_CMD_TRANSACTIONS        5u
+#define DISPLAY_MAX_TRANSACTIONS        (DISPLAY_CMD_TRANSACTIONS + DISPLAY_FRAME_CHUNKS)
+
+#if defined(CONFIG_DISPLAY_TE_SYNC) && PANEL_SCAN_ALONG_X
+/* In landscape the panel scans along our x axis, so a TE synced frame is sent as strips of columns.
+ * A strip is gathered from the frame buffer while the previous one is being transferred. */
+#define TE_STRIP_COLUMNS                40u
+#define TE_NUMBER_OF_STRIPS             (DISPLAY_WIDTH / TE_STRIP_COLUMNS)
+#define TE_STRIP_SIZE                   (TE_STRIP_COLUMNS * DISPLAY_HEIGHT * sizeof(uint16_t))
+#define DISPLAY_ARENA_SIZE              (DISPLAY_MAX_TRANSFER_SIZE + (2u * TE_STRIP_SIZE))
+#if (DISPLAY_WIDTH % TE_STRIP_COLUMNS) != 0
+#error "The screen width must be a multiple of TE_STRIP_COLUMNS"
+#endif
+#elif defined(CONFIG_DISPLAY_TE_SYNC)
+/* In portrait the scan goes along the rows of the frame buffer, so the bands are sent straight from it. */
+#define TE_NUMBER_OF_STRIPS             DISPLAY_FRAME_CHUNKS
+#define DISPLAY_ARENA_SIZE              (DISPLAY_MAX_TRANSFER_SIZE)
+#else
+#define DISPLAY_ARENA_SIZE              (DISPLAY_MAX_TRANSFER_SIZE)
+#endif
+
 
 /* Private type definitions */
 typedef struct
@@ -36,18 +80,30 @@ typedef struct
 
 /* Forward declarations */
 static void lcd_spi_pre_transfer_callback(spi_transaction_t *t);
+static void lcd_spi_post_transfer_callback(spi_transaction_t *t);
 static void lcd_cmd(spi_device_handle_t spi, const uint8_t cmd, bool keep_cs_active);
 static void lcd_data(spi_device_handle_t spi, const uint8_t *data, int len);
 static void lcd_init(spi_device_handle_t spi);
-static void send_display_data(spi_device_handle_t spi, int xPos, int yPos, int width, int height, uint16_t *linedata, bool isBufferConstant);
+static void send_display_data(spi_device_handle_t spi, int xPos, int yPos, int width, int height, uint16_t *linedata, bool isBufferConstant, bool isFlushEnd);
+static int build_display_transactions(spi_transaction_t * trans, int xPos, int yPos, int width, int height, uint16_t *linedata, bool isBufferConstant);
+static void queue_display_transactions(spi_device_handle_t spi, spi_transaction_t * trans, int count, bool isFlushEnd);
 static void wait_display_data_finish(spi_device_handle_t spi);
+static void lcd_delay_ms(uint32_t ms);
+#ifdef CONFIG_DISPLAY_TE_SYNC
+static void te_flush_task(void * param);
+#if PANEL_SCAN_ALONG_X
+static void te_gather_strip(const uint16_t * buf, int strip, uint16_t * dest);
+#endif
+#endif
+static void wait_synced_flush(void);
 
 
 //Place data into DRAM. Constant data gets placed into DROM by default, which is not accessible by DMA.
+#if PANEL_IS_ST7789
 DRAM_ATTR static const lcd_init_cmd_t st_init_cmds[]=
 {
-    /* Memory Data Access Control, MX=MV=1, MY=ML=MH=0, RGB=0 */
-    {0x36, {(1<<5)|(1<<6)}, 1},
+    /* Memory Data Access Control, rotation from the panel profile */
+    {0x36, {PANEL_MADCTL}, 1},
     /* Interface Pixel Format, 16bits/pixel for RGB/MCU interface */
     {0x3A, {0x55}, 1},
     /* Porch Setting */
@@ -74,13 +130,92 @@ DRAM_ATTR static const lcd_init_cmd_t st_init_cmds[]=
     {0xE1, {0xD0, 0x00, 0x05, 0x0D, 0x0C, 0x06, 0x2D, 0x44, 0x40, 0x0E, 0x1C, 0x18, 0x16, 0x19}, 14},
     /* Sleep Out */
     {0x11, {0}, 0x80},
+#ifdef CONFIG_DISPLAY_TE_SYNC
+    /* Tearing Effect Line On, V-blank information only */
+    {0x35, {0x00}, 1},
+#endif
+    /* Display On */
+    {0x29, {0}, 0},
+    {0, {0}, 0xff}
+};
+#define LCD_INIT_CMDS st_init_cmds
+#endif
+
+#if PANEL_IS_ILI9341
+DRAM_ATTR static const lcd_init_cmd_t ili_init_cmds[]=
+{
+    /* Power control B, power control = 0, DC_ENA = 1 */
+    {0xCF, {0x00, 0x83, 0x30}, 3},
+    /* Power on sequence control, cp1 keeps 1 frame, 1st frame enable, vcl = 0, ddvdh=3, vgh=1, vgl=2, DDVDH_ENH=1 */
+    {0xED, {0x64, 0x03, 0x12, 0x81}, 4},
+    /* Driver timing control A, non-overlap=default +1, EQ=default - 1, CR=default, pre-charge=default - 1 */
+    {0xE8, {0x85, 0x01, 0x79}, 3},
+    /* Power control A, Vcore=1.6V, DDVDH=5.6V */
+    {0xCB, {0x39, 0x2C, 0x00, 0x34, 0x02}, 5},
+    /* Pump ratio control, DDVDH=2xVCl */
+    {0xF7, {0x20}, 1},
+    /* Driver timing control, all=0 unit */
+    {0xEA, {0x00, 0x00}, 2},
+    /* Power control 1, GVDD=4.75V */
+    {0xC0, {0x26}, 1},
+    /* Power control 2, DDVDH=VCl*2, VGH=VCl*7, VGL=-VCl*3 */
+    {0xC1, {0x11}, 1},
+    /* VCOM control 1, VCOMH=4.025V, VCOML=-0.950V */
+    {0xC5, {0x35, 0x3E}, 2},
+    /* VCOM control 2, VCOMH=VMH-2, VCOML=VML-2 */
+    {0xC7, {0xBE}, 1},
+    /* Memory Access Control, rotation and BGR order from the panel profile */
+    {0x36, {PANEL_MADCTL}, 1},
+    /* Pixel format, 16bits/pixel for RGB/MCU interface */
+    {0x3A, {0x55}, 1},
+    /* Frame rate control, f=fosc, 70Hz */
+    {0xB1, {0x00, 0x1B}, 2},
+    /* Enable 3G, disabled */
+    {0xF2, {0x08}, 1},
+    /* Gamma set, curve 1 */
+    {0x26, {0x01}, 1},
+    /* Positive gamma correction */
+    {0xE0, {0x1F, 0x1A, 0x18, 0x0A, 0x0F, 0x06, 0x45, 0x87, 0x32, 0x0A, 0x07, 0x02, 0x07, 0x05, 0x00}, 15},
+    /* Negative gamma correction */
+    {0xE1, {0x00, 0x25, 0x27, 0x05, 0x10, 0x09, 0x3A, 0x78, 0x4D, 0x05, 0x18, 0x0D, 0x38, 0x3A, 0x1F}, 15},
+    /* Entry mode set, Low vol detect disabled, normal display */
+    {0xB7, {0x07}, 1},
+    /* Display function control */
+    {0xB6, {0x0A, 0x82, 0x27, 0x00}, 4},
+    /* Sleep Out */
+    {0x11, {0}, 0x80},
+#ifdef CONFIG_DISPLAY_TE_SYNC
+    /* Tearing Effect Line On, V-blank information only */
+    {0x35, {0x00}, 1},
+#endif
     /* Display On */
-    {0x29, {0}, 0x80},
+    {0x29, {0}, 0},
     {0, {0}, 0xff}
 };
+#define LCD_INIT_CMDS ili_init_cmds
+#endif
 
 static spi_device_handle_t priv_spi_handle;
 static uint16_t *line_data;
+static MemPoolArena_T *display_arena;
+
+/* Transactions for a full screen update. Only the data pointers change between frames, so they are built once. */
+static spi_transaction_t priv_frame_trans[DISPLAY_MAX_TRANSACTIONS];
+static int priv_frame_trans_count;
+
+/* Every flush started through the public functions gets the next id. They complete in the same order. */
+static uint32_t priv_flush_id = 0u;
+static volatile uint32_t priv_flushes_done = 0u;
+static volatile int64_t priv_flush_done_us[FLUSH_DONE_HISTORY];
+
+#ifdef CONFIG_DISPLAY_TE_SYNC
+#if PANEL_SCAN_ALONG_X
+static uint16_t *priv_te_strip[2];
+#endif
+static uint16_t *priv_te_frame;
+static TaskHandle_t priv_te_task;
+static SemaphoreHandle_t priv_te_done;
+#endif
 
 /********************************************************/
 /*** 		Public function definitions 			  ***/
@@ -93,11 +228,12 @@ void display_init(void)
 
     spi_device_interface_config_t devcfg=
     {
-        .clock_speed_hz=40*1000*1000,           //Clock out at 10 MHz
+        .clock_speed_hz=PANEL_SPI_CLOCK_HZ,     //Clock from the panel profile
         .mode=0,                                //SPI mode 0
         .spics_io_num=PIN_NUM_CS,               //CS pin
-        .queue_size=12,                         //We want to be able to queue 7 transactions at a time
+        .queue_size=DISPLAY_MAX_TRANSACTIONS,   //A full screen update is queued at once
         .pre_cb=lcd_spi_pre_transfer_callback,  //Specify pre-transfer callback to handle D/C line
+        .post_cb=lcd_spi_post_transfer_callback,//Records when a flush has been sent
     };
 
     printf("Initializing SPI bus... \n");
@@ -112,20 +248,92 @@ void display_init(void)
     lcd_init(priv_spi_handle);
 
     /* This buffer is used by the fill Rectangle function. */
-    line_data = heap_caps_malloc(DISPLAY_MAX_TRANSFER_SIZE, MALLOC_CAP_DMA);
+    display_arena = memPool_createArena("display", MEMPOOL_REGION_DMA, DISPLAY_ARENA_SIZE);
+    assert(display_arena != NULL);
+    line_data = memPool_alloc(display_arena, DISPLAY_MAX_TRANSFER_SIZE);
+
+    priv_frame_trans_count = build_display_transactions(priv_frame_trans, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, NULL, false);
+
+#ifdef CONFIG_DISPLAY_TE_SYNC
+#if PANEL_SCAN_ALONG_X
+    priv_te_strip[0] = memPool_alloc(display_arena, TE_STRIP_SIZE);
+    priv_te_strip[1] = memPool_alloc(display_arena, TE_STRIP_SIZE);
+    assert((priv_te_strip[0] != NULL) && (priv_te_strip[1] != NULL));
+#endif
+
+    priv_te_done = xSemaphoreCreateBinary();
+    assert(priv_te_done != NULL);
+    xSemaphoreGive(priv_te_done);
+
+    teSync_init();
+    xTaskCreate(te_flush_task, "display_te", 4096, NULL, 6, &priv_te_task);
+#endif
 }
 
+/* With TE sync the frame is handed over to the flush task, which starts it on the next TE edge.
+ * The buffer must not be written until the next call to a display function returns. */
 void display_drawScreenBuffer(uint16_t *buf)
 {
+    priv_flush_id++;
+
+#ifdef CONFIG_DISPLAY_TE_SYNC
+    xSemaphoreTake(priv_te_done, portMAX_DELAY);
+    wait_display_data_finish(priv_spi_handle);
+    priv_te_frame = buf;
+    xTaskNotifyGive(priv_te_task);
+#else
     wait_display_data_finish(priv_spi_handle);
-    send_display_data(priv_spi_handle, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, buf, false);
+
+    for (int ix = DISPLAY_CMD_TRANSACTIONS; ix < priv_frame_trans_count; ix++)
+    {
+        priv_frame_trans[ix].tx_buffer = buf + ((ix - DISPLAY_CMD_TRANSACTIONS) * (DISPLAY_MAX_TRANSFER_SIZE / 2u));
+    }
+    queue_display_transactions(priv_spi_handle, priv_frame_trans, priv_frame_trans_count, true);
+#endif
 }
 
 
 void display_drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *bmp_buf)
 {
+    priv_flush_id++;
+    wait_synced_flush();
+    wait_display_data_finish(priv_spi_handle);
+    send_display_data(priv_spi_handle, x, y, width, height, bmp_buf, false, true);
+}
+
+/* Blocks until everything sent to the display has been transferred. */
+void display_waitTransferDone(void)
+{
+    wait_synced_flush();
     wait_display_data_finish(priv_spi_handle);
-    send_display_data(priv_spi_handle, x, y, width, height, bmp_buf, false);
+}
+
+/* Id of the most recently started flush. */
+uint32_t display_getFlushId(void)
+{
+    return priv_flush_id;
+}
+
+/* Returns true once the given flush has been sent to the panel. The time is 0 if it is too old to be known. */
+bool display_getFlushDoneTime(uint32_t flush_id, int64_t *time_us)
+{
+    uint32_t flushes_done = priv_flushes_done;
+
+    if ((int32_t)(flushes_done - flush_id) < 0)
+    {
+        return false;
+    }
+
+    if ((flushes_done - flush_id) >= FLUSH_DONE_HISTORY)
+    {
+        *time_us = 0;
+    }
+    else
+    {
+        *time_us = priv_flush_done_us[flush_id & (FLUSH_DONE_HISTORY - 1u)];
+    }
+
+    return true;
 }
 
 /* TODO : Comment this. */
@@ -141,8 +349,10 @@ void display_fillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t heig
     	line_data[x] = color;
     }
 
+	priv_flush_id++;
+	wait_synced_flush();
 	wait_display_data_finish(priv_spi_handle);
-	send_display_data(priv_spi_handle, x, y, width, height, line_data, true);
+	send_display_data(priv_spi_handle, x, y, width, height, line_data, true, true);
 
     //heap_caps_free(line_data);
 }
@@ -156,16 +366,30 @@ void display_fillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t heig
 //set the D/C line to the value indicated in the user field.
 static void lcd_spi_pre_transfer_callback(spi_transaction_t *t)
 {
-    int dc=(int)t->user;
+    int dc=(int)t->user & LCD_USER_DC;
     gpio_set_level(PIN_NUM_DC, dc);
 }
 
+//Called (also in irq context) when a transaction is done. The completion time of each flush is kept for
+//display_getFlushDoneTime.
+static void lcd_spi_post_transfer_callback(spi_transaction_t *t)
+{
+    if ((int)t->user & LCD_USER_FLUSH_END)
+    {
+        uint32_t flushes_done = priv_flushes_done + 1u;
+        priv_flush_done_us[flushes_done & (FLUSH_DONE_HISTORY - 1u)] = esp_timer_get_time();
+        priv_flushes_done = flushes_done;
+    }
+}
+
 
 //Initialize the display
 static void lcd_init(spi_device_handle_t spi)
 {
     int cmd=0;
     const lcd_init_cmd_t* lcd_init_cmds;
+    int64_t reset_time_us;
+    int64_t since_reset_ms;
 
     //Initialize non-SPI GPIOs
     gpio_config_t io_conf = {};
@@ -174,23 +398,34 @@ static void lcd_init(spi_device_handle_t spi)
     io_conf.pull_up_en = true;
     gpio_config(&io_conf);
 
-    //Reset the display
+    //Reset the display. Only wait as long as the datasheet requires, the rest of the boot runs meanwhile.
     gpio_set_level(PIN_NUM_RST, 0);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
+    esp_rom_delay_us(LCD_RESET_PULSE_US);
     gpio_set_level(PIN_NUM_RST, 1);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
+    reset_time_us = esp_timer_get_time();
+    lcd_delay_ms(LCD_RESET_TO_CMD_MS);
 
-    lcd_init_cmds = st_init_cmds;
+    lcd_init_cmds = LCD_INIT_CMDS;
 
     //Send all the commands
     while (lcd_init_cmds[cmd].databytes!=0xff)
     {
+        if (lcd_init_cmds[cmd].cmd == LCD_CMD_SLEEP_OUT)
+        {
+            /* The configuration commands before this were sent during the wait. */
+            since_reset_ms = (esp_timer_get_time() - reset_time_us) / 1000;
+            if (since_reset_ms < LCD_RESET_TO_SLEEP_OUT_MS)
+            {
+                lcd_delay_ms(LCD_RESET_TO_SLEEP_OUT_MS - since_reset_ms);
+            }
+        }
+
         lcd_cmd(spi, lcd_init_cmds[cmd].cmd, false);
         lcd_data(spi, lcd_init_cmds[cmd].data, lcd_init_cmds[cmd].databytes&0x1F);
 
         if (lcd_init_cmds[cmd].databytes&0x80)
         {
-            vTaskDelay(100 / portTICK_PERIOD_MS);
+            lcd_delay_ms(LCD_SLEEP_OUT_DELAY_MS);
         }
 
         cmd++;
@@ -201,6 +436,13 @@ static void lcd_init(spi_device_handle_t spi)
 }
 
 
+/* Waits at least the given time. vTaskDelay can return up to one tick early, so one extra tick is added. */
+static void lcd_delay_ms(uint32_t ms)
+{
+    vTaskDelay(((ms + portTICK_PERIOD_MS - 1u) / portTICK_PERIOD_MS) + 1u);
+}
+
+
 /* Send a command to the LCD. Uses spi_device_polling_transmit, which waits
  * until the transfer is complete.
  *
@@ -247,28 +489,35 @@ static void lcd_data(spi_device_handle_t spi, const uint8_t *data, int len)
 
 uint8_t priv_number_of_transfers = 0u;
 
-/* Updates the whole screen */
-static void send_display_data(spi_device_handle_t spi, int xPos, int yPos, int width, int height, uint16_t *linedata, bool isBufferConstant)
+/* Updates a rectangle of the screen */
+static void send_display_data(spi_device_handle_t spi, int xPos, int yPos, int width, int height, uint16_t *linedata, bool isBufferConstant, bool isFlushEnd)
+{
+    //Transaction descriptors. Declared static so they're not allocated on the stack; we need this memory even when this
+    //function is finished because the SPI driver needs access to it even while we're already calculating the next line.
+    static spi_transaction_t trans[DISPLAY_MAX_TRANSACTIONS];
+
+    queue_display_transactions(spi, trans, build_display_transactions(trans, xPos, yPos, width, height, linedata, isBufferConstant), isFlushEnd);
+}
+
+
+/* Fills in the transactions for writing a rectangle and returns how many were used. The panel RAM offset
+ * and the chunk size are profile constants, so there is nothing here that depends on the panel at run time. */
+static int build_display_transactions(spi_transaction_t * trans, int xPos, int yPos, int width, int height, uint16_t *linedata, bool isBufferConstant)
 {
-    esp_err_t ret;
     int total_size_bytes = width * height * 2;
-    int chunk_ix = 5;
+    int chunk_ix = DISPLAY_CMD_TRANSACTIONS;
     uint16_t * line_ptr;
     int curr_transfer_size;
 
-    //Transaction descriptors. Declared static so they're not allocated on the stack; we need this memory even when this
-    //function is finished because the SPI driver needs access to it even while we're already calculating the next line.
-    static spi_transaction_t trans[12];
-
 	uint16_t end_column = (xPos + width) - 1u;
     uint16_t end_row = (yPos + height) - 1u;
 
-    end_column = MIN(end_column, DISPLAY_WIDTH);
-    end_row = MIN(end_row, DISPLAY_HEIGHT);
+    end_column = MIN(end_column, DISPLAY_WIDTH) + PANEL_X_OFFSET;
+    end_row = MIN(end_row, DISPLAY_HEIGHT) + PANEL_Y_OFFSET;
+    xPos += PANEL_X_OFFSET;
+    yPos += PANEL_Y_OFFSET;
 
-    //In theory, it's better to initialize trans and data only once and hang on to the initialized
-    //variables. We allocate them on the stack, so we need to re-init them each call.
-    for (int ix = 0; ix < 12; ix++)
+    for (int ix = 0; ix < DISPLAY_MAX_TRANSACTIONS; ix++)
     {
         memset(&trans[ix], 0, sizeof(spi_transaction_t));
         trans[ix].flags=SPI_TRANS_USE_TXDATA;
@@ -302,7 +551,7 @@ static void send_display_data(spi_device_handle_t spi, int xPos, int yPos, int w
 
     line_ptr = linedata;
 
-    while(total_size_bytes > 0)
+    while((total_size_bytes > 0) && (chunk_ix < DISPLAY_MAX_TRANSACTIONS))
     {
     	curr_transfer_size = MIN(total_size_bytes, DISPLAY_MAX_TRANSFER_SIZE);
     	trans[chunk_ix].tx_buffer = line_ptr;        			//finally send the line data
@@ -313,17 +562,35 @@ static void send_display_data(spi_device_handle_t spi, int xPos, int yPos, int w
     	chunk_ix++;
     	total_size_bytes -= curr_transfer_size;
 
-    	if(!isBufferConstant)
+    	if((!isBufferConstant) && (line_ptr != NULL))
     	{
     		line_ptr += (curr_transfer_size / 2); //Not ideal... We have a U16 ptr, but transfer size is in bytes...
     	}
     }
 
-    trans[chunk_ix - 1].flags = 0;
-    priv_number_of_transfers = chunk_ix;
+    assert(total_size_bytes <= 0);
+    return chunk_ix;
+}
+
+
+static void queue_display_transactions(spi_device_handle_t spi, spi_transaction_t * trans, int count, bool isFlushEnd)
+{
+    TRACE_SCOPE("send_display_data");
+    esp_err_t ret;
+
+    priv_number_of_transfers = count;
+
+    if (isFlushEnd)
+    {
+        trans[count - 1].user = (void*)((int)trans[count - 1].user | LCD_USER_FLUSH_END);
+    }
+    else
+    {
+        trans[count - 1].user = (void*)((int)trans[count - 1].user & ~LCD_USER_FLUSH_END);
+    }
 
     //Queue all transactions.
-    for (int ix=0; ix < chunk_ix; ix++)
+    for (int ix=0; ix < count; ix++)
     {
         ret=spi_device_queue_trans(spi, &trans[ix], portMAX_DELAY);
         assert(ret==ESP_OK);
@@ -333,6 +600,7 @@ static void send_display_data(spi_device_handle_t spi, int xPos, int yPos, int w
 
 static void wait_display_data_finish(spi_device_handle_t spi)
 {
+    TRACE_SCOPE("spi_wait");
     spi_transaction_t *rtrans;
     esp_err_t ret;
     //Wait for all transactions to be done and get back the results.
@@ -344,3 +612,90 @@ static void wait_display_data_finish(spi_device_handle_t spi)
     }
     priv_number_of_transfers = 0u;
 }
+
+
+/* Other transfers must not be queued while the TE flush task owns the bus transactions. */
+static void wait_synced_flush(void)
+{
+#ifdef CONFIG_DISPLAY_TE_SYNC
+    xSemaphoreTake(priv_te_done, portMAX_DELAY);
+    xSemaphoreGive(priv_te_done);
+#endif
+}
+
+
+#ifdef CONFIG_DISPLAY_TE_SYNC
+/* Sends each frame starting on a TE edge, strip by strip in the scan direction. The write then
+ * stays behind the scanout for the first refresh and ahead of it for the next one, as long as the
+ * transfer takes less than two refresh periods. */
+static void te_flush_task(void * param)
+{
+    int64_t start_us;
+#if PANEL_SCAN_ALONG_X
+    int buf_ix;
+#endif
+
+    while(1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        TRACE_BEGIN("te_flush");
+
+#if PANEL_SCAN_ALONG_X
+        buf_ix = 0;
+        te_gather_strip(priv_te_frame, 0, priv_te_strip[buf_ix]);
+#endif
+
+        /* Without an edge the frame is sent anyway, it may tear. */
+        (void)teSync_waitForTe();
+        start_us = esp_timer_get_time();
+
+        for (int strip = 0; strip < TE_NUMBER_OF_STRIPS; strip++)
+        {
+#ifdef CONFIG_DISPLAY_SCAN_REVERSED
+            int pos = TE_NUMBER_OF_STRIPS - 1 - strip;
+#else
+            int pos = strip;
+#endif
+#if PANEL_SCAN_ALONG_X
+            send_display_data(priv_spi_handle, pos * TE_STRIP_COLUMNS, 0, TE_STRIP_COLUMNS, DISPLAY_HEIGHT, priv_te_strip[buf_ix], false, (strip + 1) == TE_NUMBER_OF_STRIPS);
+
+            buf_ix ^= 1;
+            if ((strip + 1) < TE_NUMBER_OF_STRIPS)
+            {
+                te_gather_strip(priv_te_frame, strip + 1, priv_te_strip[buf_ix]);
+            }
+#else
+            int y = pos * DISPLAY_TRANSFER_ROWS;
+            send_display_data(priv_spi_handle, 0, y, DISPLAY_WIDTH, MIN(DISPLAY_TRANSFER_ROWS, DISPLAY_HEIGHT - y), priv_te_frame + (y * DISPLAY_WIDTH), false, (strip + 1) == TE_NUMBER_OF_STRIPS);
+#endif
+
+            wait_display_data_finish(priv_spi_handle);
+        }
+
+        teSync_checkWrite(start_us, esp_timer_get_time());
+
+        TRACE_END("te_flush");
+        xSemaphoreGive(priv_te_done);
+    }
+}
+
+
+#if PANEL_SCAN_ALONG_X
+/* Copies the columns of one strip, in scan order, into a contiguous buffer. */
+static void te_gather_strip(const uint16_t * buf, int strip, uint16_t * dest)
+{
+#ifdef CONFIG_DISPLAY_SCAN_REVERSED
+    const uint16_t * src = buf + ((TE_NUMBER_OF_STRIPS - 1 - strip) * TE_STRIP_COLUMNS);
+#else
+    const uint16_t * src = buf + (strip * TE_STRIP_COLUMNS);
+#endif
+
+    for (int y = 0; y < DISPLAY_HEIGHT; y++)
+    {
+        memcpy(dest, src, TE_STRIP_COLUMNS * sizeof(uint16_t));
+        dest += TE_STRIP_COLUMNS;
+        src += DISPLAY_WIDTH;
+    }
+}
+#endif /* PANEL_SCAN_ALONG_X */
+#endif
@@ -15,8 +15,12 @@
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 #endif
 
+#include <stdint.h>
+#include <stdbool.h>
 
-#define MAX_BMP_LINE_LENGTH 320u
+#include "panelProfile.h"
+
+#define MAX_BMP_LINE_LENGTH MAX(PANEL_WIDTH, PANEL_HEIGHT)
 #define CONVERT_888RGB_TO_565RGB(r, g, b) (((r >> 3) << 3) | (g >> 5) | (((g >> 2) & 0x7u) << 13) | ((b >> 3) << 8))
 
 #define COLOR_BLACK    CONVERT_888RGB_TO_565RGB(0,  0,  0   )
@@ -28,14 +32,20 @@
 #define COLOR_YELLOW   CONVERT_888RGB_TO_565RGB(255,255,0   )
 #define COLOR_WHITE    CONVERT_888RGB_TO_565RGB(255,255,255 )
 
-#define DISPLAY_WIDTH 320u
-#define DISPLAY_HEIGHT 240u
+#define DISPLAY_WIDTH PANEL_WIDTH
+#define DISPLAY_HEIGHT PANEL_HEIGHT
 
-#define DISPLAY_MAX_TRANSFER_SIZE 40*320*2
+/* A full frame goes out in chunks of the same 25 kB that 40 lines of the 320 wide landscape screen take. */
+#define DISPLAY_TRANSFER_ROWS ((40u * 320u) / DISPLAY_WIDTH)
+#define DISPLAY_MAX_TRANSFER_SIZE (DISPLAY_TRANSFER_ROWS * DISPLAY_WIDTH * 2u)
+#define DISPLAY_FRAME_CHUNKS ((DISPLAY_HEIGHT + DISPLAY_TRANSFER_ROWS - 1u) / DISPLAY_TRANSFER_ROWS)
 
 void display_init(void);
 void display_drawScreenBuffer(uint16_t *buf);
 void display_fillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color);
 void display_drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *bmp_buf);
+void display_waitTransferDone(void);
+uint32_t display_getFlushId(void);
+bool display_getFlushDoneTime(uint32_t flush_id, int64_t *time_us);
 
 #endif /* MAIN_DISPLAY_H_ */
@@ -0,0 +1,336 @@
+/*
+ * frameCapture.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/stat.h>
+
+#include "sdkconfig.h"
+
+#ifdef CONFIG_CAPTURE_ENABLE
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "frameCapture.h"
+#include "display.h"
+
+/****************** Private defines *******************/
+
+#define CAPTURE_FILE_MAGIC		0x50414345u		/* "ECAP" */
+#define CAPTURE_FILE_VERSION	1u
+#define CAPTURE_ENCODING_RLE16	1u
+
+/* Runs shorter than this are cheaper to store as literals. */
+#define RLE_MIN_RUN				3
+#define RLE_RUN_FLAG			0x8000u
+#define RLE_MAX_PACKET			0x7fff
+
+#define CHUNK_WORDS				(FRAME_CAPTURE_CHUNK_SIZE / sizeof(uint16_t))
+#define MAX_CAPTURE_FILES		100000u
+
+/* Below the game loop and the render workers, it only runs when they have nothing to do. */
+#define WRITER_TASK_STACK_SIZE	4096u
+#define WRITER_TASK_PRIORITY	(tskIDLE_PRIORITY + 1u)
+
+/****************** Private type definitions *******************/
+
+#pragma pack(push)
+#pragma pack(1)
+/* The file is this header followed by the RLE16 packets of the frame, row by row. A packet starts
+ * with a header word : with RLE_RUN_FLAG set, the next word is repeated (header & 0x7fff) times,
+ * otherwise (header) literal words follow. Pixels are in the display format. */
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t width;
+	uint16_t height;
+	uint16_t encoding;
+	uint32_t tick;
+} CaptureFileHeader_T;
+#pragma pack(pop)
+
+/**************** Private function forward declarations **************/
+
+static void priv_writerTask(void * param);
+static void priv_writeCapture(void);
+static bool priv_writeChunk(FILE * f, const uint16_t * data, int words);
+static int priv_encodeRow(const uint16_t * src, int count, uint16_t * out);
+static bool priv_openNextFile(FILE ** f, char * path, size_t path_size);
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Capture";
+
+static uint16_t * priv_staging;
+static uint16_t * priv_row_buf;
+static uint16_t * priv_chunk;
+
+static TaskHandle_t priv_writer_task;
+static volatile bool priv_is_busy = false;
+static bool priv_is_requested = false;
+static uint32_t priv_staged_tick;
+static uint32_t priv_last_capture_tick = 0u;
+static uint32_t priv_next_file_index = 0u;
+
+static FrameCaptureCounters_T priv_counters;
+
+/**************** Public functions  **************/
+
+void frameCapture_init(MemPoolArena_T * arena)
+{
+	priv_staging = memPool_alloc(arena, DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(uint16_t));
+	priv_row_buf = memPool_alloc(arena, 2u * DISPLAY_WIDTH * sizeof(uint16_t));
+	priv_chunk = memPool_alloc(arena, FRAME_CAPTURE_CHUNK_SIZE);
+	assert(priv_staging && priv_row_buf && priv_chunk);
+
+	xTaskCreate(priv_writerTask, "capture", WRITER_TASK_STACK_SIZE, NULL, WRITER_TASK_PRIORITY, &priv_writer_task);
+
+#if CONFIG_CAPTURE_INTERVAL_TICKS > 0
+	ESP_LOGI(TAG, "Capturing every %d ticks to %s", CONFIG_CAPTURE_INTERVAL_TICKS, CONFIG_CAPTURE_DIR);
+#else
+	ESP_LOGI(TAG, "Capturing on request to %s", CONFIG_CAPTURE_DIR);
+#endif
+}
+
+
+void frameCapture_request(void)
+{
+	priv_is_requested = true;
+}
+
+
+/* Only a copy is made here. Compressing and writing happen in the writer task. */
+void frameCapture_onFlush(const uint16_t * frame_buf, uint32_t tick)
+{
+	int64_t start_us;
+
+#if CONFIG_CAPTURE_INTERVAL_TICKS > 0
+	if ((tick - priv_last_capture_tick) >= CONFIG_CAPTURE_INTERVAL_TICKS)
+	{
+		priv_is_requested = true;
+	}
+#endif
+
+	if (!priv_is_requested)
+	{
+		return;
+	}
+
+	priv_is_requested = false;
+	priv_last_capture_tick = tick;
+	priv_counters.requests++;
+
+	if (priv_is_busy)
+	{
+		priv_counters.busy_skips++;
+		return;
+	}
+
+	start_us = esp_timer_get_time();
+	memcpy(priv_staging, frame_buf, DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(uint16_t));
+	priv_counters.max_copy_us = MAX(priv_counters.max_copy_us, (uint32_t)(esp_timer_get_time() - start_us));
+
+	priv_staged_tick = tick;
+	priv_is_busy = true;
+	xTaskNotifyGive(priv_writer_task);
+}
+
+
+bool frameCapture_isBusy(void)
+{
+	return priv_is_busy;
+}
+
+
+void frameCapture_getCounters(FrameCaptureCounters_T * counters)
+{
+	*counters = priv_counters;
+}
+
+
+void frameCapture_printCounters(void)
+{
+	ESP_LOGI(TAG, "Captures %lu of %lu requested (%lu skipped while busy, %lu failed), %lu kB written for %lu kB, copy max %lu us",
+			(unsigned long)priv_counters.captures,
+			(unsigned long)priv_counters.requests,
+			(unsigned long)priv_counters.busy_skips,
+			(unsigned long)priv_counters.write_errors,
+			(unsigned long)(priv_counters.written_bytes / 1024u),
+			(unsigned long)(priv_counters.raw_bytes / 1024u),
+			(unsigned long)priv_counters.max_copy_us);
+}
+
+/*********** Private functions ***********/
+
+static void priv_writerTask(void * param)
+{
+	while(1)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		priv_writeCapture();
+		priv_is_busy = false;
+	}
+}
+
+
+static void priv_writeCapture(void)
+{
+	CaptureFileHeader_T header;
+	char path[64];
+	FILE * f;
+	int fill;
+	int row_words;
+	uint32_t written = sizeof(header);
+	bool is_ok;
+
+	if (!priv_openNextFile(&f, path, sizeof(path)))
+	{
+		priv_counters.write_errors++;
+		return;
+	}
+
+	memset(&header, 0, sizeof(header));
+	header.magic = CAPTURE_FILE_MAGIC;
+	header.version = CAPTURE_FILE_VERSION;
+	header.width = DISPLAY_WIDTH;
+	header.height = DISPLAY_HEIGHT;
+	header.encoding = CAPTURE_ENCODING_RLE16;
+	header.tick = priv_staged_tick;
+
+	memcpy(priv_chunk, &header, sizeof(header));
+	fill = sizeof(header) / sizeof(uint16_t);
+	is_ok = true;
+
+	for (int y = 0; (y < DISPLAY_HEIGHT) && is_ok; y++)
+	{
+		row_words = priv_encodeRow(priv_staging + (y * DISPLAY_WIDTH), DISPLAY_WIDTH, priv_row_buf);
+
+		if ((fill + row_words) > CHUNK_WORDS)
+		{
+			is_ok = priv_writeChunk(f, priv_chunk, fill);
+			written += (fill * sizeof(uint16_t));
+			fill = 0;
+		}
+
+		memcpy(&priv_chunk[fill], priv_row_buf, row_words * sizeof(uint16_t));
+		fill += row_words;
+	}
+
+	if (is_ok && (fill > 0))
+	{
+		is_ok = priv_writeChunk(f, priv_chunk, fill);
+		written += (fill * sizeof(uint16_t));
+	}
+
+	if ((fclose(f) != 0) || !is_ok)
+	{
+		ESP_LOGE(TAG, "Failed to write %s", path);
+		priv_counters.write_errors++;
+		return;
+	}
+
+	priv_counters.captures++;
+	priv_counters.raw_bytes += DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(uint16_t);
+	priv_counters.written_bytes += written;
+	ESP_LOGI(TAG, "Tick %lu captured to %s, %lu bytes", (unsigned long)priv_staged_tick, path, (unsigned long)written);
+}
+
+
+/* The card shares the SPI bus with the display. Chunks are only written once the last flush has been sent,
+ * so a write fits in the gap before the next frame instead of holding up its transfer. */
+static bool priv_writeChunk(FILE * f, const uint16_t * data, int words)
+{
+	int64_t done_us;
+
+	while (!display_getFlushDoneTime(display_getFlushId(), &done_us))
+	{
+		vTaskDelay(1);
+	}
+
+	return (fwrite(data, sizeof(uint16_t), words, f) == (size_t)words);
+}
+
+
+/* Encodes one row, returns the number of words written to out. out must have room for 2 * count words. */
+static int priv_encodeRow(const uint16_t * src, int count, uint16_t * out)
+{
+	int ix = 0;
+	int n = 0;
+	int run;
+	int start;
+
+	while (ix < count)
+	{
+		run = 1;
+		while (((ix + run) < count) && (src[ix + run] == src[ix]) && (run < RLE_MAX_PACKET))
+		{
+			run++;
+		}
+
+		if (run >= RLE_MIN_RUN)
+		{
+			out[n++] = RLE_RUN_FLAG | (uint16_t)run;
+			out[n++] = src[ix];
+			ix += run;
+			continue;
+		}
+
+		/* Literal up to the start of the next run. */
+		start = ix;
+		while ((ix < count) && ((ix - start) < RLE_MAX_PACKET))
+		{
+			if (((ix + 2) < count) && (src[ix] == src[ix + 1]) && (src[ix] == src[ix + 2]))
+			{
+				break;
+			}
+			ix++;
+		}
+
+		out[n++] = (uint16_t)(ix - start);
+		memcpy(&out[n], &src[start], (ix - start) * sizeof(uint16_t));
+		n += (ix - start);
+	}
+
+	return n;
+}
+
+
+/* Files are numbered CAP00000.ECP, CAP00001.ECP ... so that they also work without long file names.
+ * Numbering continues after the files already on the card. */
+static bool priv_openNextFile(FILE ** f, char * path, size_t path_size)
+{
+	struct stat st;
+
+	while (priv_next_file_index < MAX_CAPTURE_FILES)
+	{
+		snprintf(path, path_size, "%s/CAP%05lu.ECP", CONFIG_CAPTURE_DIR, (unsigned long)priv_next_file_index);
+		priv_next_file_index++;
+
+		if (stat(path, &st) != 0)
+		{
+			*f = fopen(path, "wb");
+			if (*f == NULL)
+			{
+				ESP_LOGE(TAG, "Failed to open %s for writing", path);
+				return false;
+			}
+
+			/* Every chunk goes to the card as it is written, not when the stdio buffer happens to fill up. */
+			setvbuf(*f, NULL, _IONBF, 0);
+			return true;
+		}
+	}
+
+	ESP_LOGE(TAG, "No free capture file names left in %s", CONFIG_CAPTURE_DIR);
+	return false;
+}
+
+#endif /* CONFIG_CAPTURE_ENABLE */
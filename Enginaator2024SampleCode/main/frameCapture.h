@@ -0,0 +1,54 @@
+/*
+ * frameCapture.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Frame buffer capture to the SD card. A flushed frame is copied into a staging buffer, and a
+ *  low priority task compresses it and writes it to the card in small chunks while the display
+ *  is idle. The game loop never waits for it : a capture that comes while the previous one is
+ *  still being written is skipped. Convert the files with tools/capture2png.py.
+ */
+
+#ifndef MAIN_FRAMECAPTURE_H_
+#define MAIN_FRAMECAPTURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "memPool.h"
+#include "display.h"
+
+/* Staging copy of a frame, one encoded row and one write chunk. */
+#define FRAME_CAPTURE_CHUNK_SIZE	4096u
+#define FRAME_CAPTURE_ARENA_SIZE	((DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(uint16_t)) + \
+									 (2u * DISPLAY_WIDTH * sizeof(uint16_t)) + FRAME_CAPTURE_CHUNK_SIZE + 64u)
+
+typedef struct
+{
+	uint32_t requests;
+	uint32_t captures;			/* Written to the card */
+	uint32_t busy_skips;		/* Requested while the previous capture was being written */
+	uint32_t write_errors;
+	uint32_t raw_bytes;
+	uint32_t written_bytes;
+	uint32_t max_copy_us;		/* Longest time the game loop spent in frameCapture_onFlush */
+} FrameCaptureCounters_T;
+
+/* Reserves the staging buffer from the arena and starts the writer task. */
+extern void frameCapture_init(MemPoolArena_T * arena);
+
+/* Captures the next flushed frame. */
+extern void frameCapture_request(void);
+
+/* Called after a frame buffer has been handed to the display. The tick is stored in the capture,
+ * so captures of an input replay can be matched with golden images. */
+extern void frameCapture_onFlush(const uint16_t * frame_buf, uint32_t tick);
+
+/* True while a capture is being written to the card. The bus must then stay clocked, no light sleep. */
+extern bool frameCapture_isBusy(void);
+
+extern void frameCapture_getCounters(FrameCaptureCounters_T * counters);
+extern void frameCapture_printCounters(void);
+
+#endif /* MAIN_FRAMECAPTURE_H_ */
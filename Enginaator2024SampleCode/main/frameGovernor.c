@@ -0,0 +1,221 @@
+/*
+ * frameGovernor.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "frameGovernor.h"
+#include "inputReplay.h"
+
+/****************** Private defines *******************/
+
+/* Quality is lowered when the average cost goes above the high mark for a few frames,
+ * and raised again only after it has stayed below the low mark for a longer time. */
+#define COST_HIGH_MARK_US 	((GOVERNOR_FRAME_PERIOD_US * 90u) / 100u)
+#define COST_LOW_MARK_US 	((GOVERNOR_FRAME_PERIOD_US * 55u) / 100u)
+
+#define FRAMES_BEFORE_DOWNGRADE 	3u
+#define FRAMES_BEFORE_UPGRADE 		(2u * CONFIG_TARGET_FPS)
+
+/* Average is an exponential moving average with weight 1/8 for the newest frame. */
+#define COST_AVERAGE_SHIFT 3u
+
+/****************** Private type definitions *******************/
+
+typedef struct
+{
+	uint8_t star_pct;
+	uint8_t particle_pct;
+	bool isPartialRefresh;
+	bool isHalfRate;
+} GovernorLevelDef_T;
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Frame Governor";
+
+static const GovernorLevelDef_T priv_levels[NUMBER_OF_GOVERNOR_LEVELS] =
+{
+	[GOVERNOR_LEVEL_FULL] 		= { .star_pct = 100u, .particle_pct = 100u, .isPartialRefresh = false, .isHalfRate = false },
+	[GOVERNOR_LEVEL_REDUCED] 	= { .star_pct = 50u,  .particle_pct = 50u,  .isPartialRefresh = false, .isHalfRate = false },
+	[GOVERNOR_LEVEL_PARTIAL] 	= { .star_pct = 0u,   .particle_pct = 25u,  .isPartialRefresh = true,  .isHalfRate = false },
+	[GOVERNOR_LEVEL_HALF_RATE] 	= { .star_pct = 0u,   .particle_pct = 25u,  .isPartialRefresh = true,  .isHalfRate = true  },
+};
+
+static GovernorLevel_T priv_level = GOVERNOR_LEVEL_FULL;
+static GovernorCounters_T priv_counters;
+
+static int64_t priv_frame_start_us = 0;
+static uint32_t priv_avg_cost_us = 0u;
+static uint32_t priv_frames_over = 0u;
+static uint32_t priv_frames_under = 0u;
+static bool priv_isRenderFrame = true;
+static bool priv_isUnchangedFrame = false;
+static bool priv_isOddFrame = false;
+
+/**************** Public functions  **************/
+
+void frameGovernor_frameStart(void)
+{
+	priv_frame_start_us = esp_timer_get_time();
+
+	priv_isOddFrame = !priv_isOddFrame;
+	priv_isRenderFrame = !(priv_levels[priv_level].isHalfRate && priv_isOddFrame);
+	priv_isUnchangedFrame = false;
+}
+
+
+void frameGovernor_frameEnd(void)
+{
+	uint32_t cost_us = (uint32_t)(esp_timer_get_time() - priv_frame_start_us);
+
+	priv_counters.frames++;
+	priv_counters.frames_at_level[priv_level]++;
+
+	if (!priv_isRenderFrame)
+	{
+		/* Skipped frames say nothing about how expensive rendering is. */
+		priv_counters.skipped_renders++;
+		return;
+	}
+
+	if (priv_isUnchangedFrame)
+	{
+		/* Neither do frames the idle monitor skipped, they would pull the average down and raise the quality. */
+		priv_counters.unchanged_frames++;
+		return;
+	}
+
+	priv_counters.rendered_frames++;
+
+	if (cost_us > GOVERNOR_FRAME_PERIOD_US)
+	{
+		priv_counters.missed_deadlines++;
+	}
+
+	if (priv_avg_cost_us == 0u)
+	{
+		priv_avg_cost_us = cost_us;
+	}
+	else
+	{
+		priv_avg_cost_us = priv_avg_cost_us - (priv_avg_cost_us >> COST_AVERAGE_SHIFT) + (cost_us >> COST_AVERAGE_SHIFT);
+	}
+	priv_counters.avg_frame_cost_us = priv_avg_cost_us;
+
+#ifdef CONFIG_FRAME_GOVERNOR
+	/* The level depends on timing, so it is held during a replay. A replay starts on the first frame,
+	 * so it always runs at full quality, with every frame rendered and the same particle budget on every run. */
+	if (inputReplay_isPlaying())
+	{
+		return;
+	}
+
+	priv_frames_over = (priv_avg_cost_us > COST_HIGH_MARK_US) ? (priv_frames_over + 1u) : 0u;
+	priv_frames_under = (priv_avg_cost_us < COST_LOW_MARK_US) ? (priv_frames_under + 1u) : 0u;
+
+	if ((priv_frames_over >= FRAMES_BEFORE_DOWNGRADE) && (priv_level < (NUMBER_OF_GOVERNOR_LEVELS - 1)))
+	{
+		priv_level++;
+		priv_counters.level_downgrades++;
+		priv_frames_over = 0u;
+		/* Start the average from scratch, the old value was measured with more work. */
+		priv_avg_cost_us = 0u;
+		ESP_LOGI(TAG, "Frame cost over budget, quality level %d", priv_level);
+	}
+	else if ((priv_frames_under >= FRAMES_BEFORE_UPGRADE) && (priv_level > GOVERNOR_LEVEL_FULL))
+	{
+		priv_level--;
+		priv_counters.level_upgrades++;
+		priv_frames_under = 0u;
+		priv_avg_cost_us = 0u;
+		ESP_LOGI(TAG, "Frame cost within budget, quality level %d", priv_level);
+	}
+#endif
+}
+
+
+bool frameGovernor_shouldRender(void)
+{
+	return priv_isRenderFrame;
+}
+
+
+void frameGovernor_reportUnchanged(void)
+{
+	priv_isUnchangedFrame = true;
+}
+
+
+bool frameGovernor_isPartialRefreshAllowed(void)
+{
+	return priv_levels[priv_level].isPartialRefresh;
+}
+
+
+void frameGovernor_reportFlush(bool isPartial)
+{
+	if (isPartial)
+	{
+		priv_counters.partial_flushes++;
+	}
+	else
+	{
+		priv_counters.full_flushes++;
+	}
+}
+
+
+uint16_t frameGovernor_getStarCount(uint16_t max_stars)
+{
+	return (uint16_t)((max_stars * priv_levels[priv_level].star_pct) / 100u);
+}
+
+
+uint16_t frameGovernor_getParticleBudget(uint16_t max_particles)
+{
+	return (uint16_t)((max_particles * priv_levels[priv_level].particle_pct) / 100u);
+}
+
+
+GovernorLevel_T frameGovernor_getLevel(void)
+{
+	return priv_level;
+}
+
+
+void frameGovernor_getCounters(GovernorCounters_T * counters)
+{
+	*counters = priv_counters;
+}
+
+
+void frameGovernor_printCounters(void)
+{
+	ESP_LOGI(TAG, "Level %d, average cost %lu us of %u us. Frames %lu, rendered %lu, skipped %lu, unchanged %lu, missed deadlines %lu",
+			priv_level,
+			(unsigned long)priv_counters.avg_frame_cost_us,
+			GOVERNOR_FRAME_PERIOD_US,
+			(unsigned long)priv_counters.frames,
+			(unsigned long)priv_counters.rendered_frames,
+			(unsigned long)priv_counters.skipped_renders,
+			(unsigned long)priv_counters.unchanged_frames,
+			(unsigned long)priv_counters.missed_deadlines);
+
+	ESP_LOGI(TAG, "Flushes full %lu, partial %lu. Downgrades %lu, upgrades %lu. Frames per level %lu / %lu / %lu / %lu",
+			(unsigned long)priv_counters.full_flushes,
+			(unsigned long)priv_counters.partial_flushes,
+			(unsigned long)priv_counters.level_downgrades,
+			(unsigned long)priv_counters.level_upgrades,
+			(unsigned long)priv_counters.frames_at_level[GOVERNOR_LEVEL_FULL],
+			(unsigned long)priv_counters.frames_at_level[GOVERNOR_LEVEL_REDUCED],
+			(unsigned long)priv_counters.frames_at_level[GOVERNOR_LEVEL_PARTIAL],
+			(unsigned long)priv_counters.frames_at_level[GOVERNOR_LEVEL_HALF_RATE]);
+}
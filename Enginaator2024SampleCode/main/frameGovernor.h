@@ -0,0 +1,77 @@
+/*
+ * frameGovernor.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Keeps the frame deadline under load. Measures how long rendering and flushing take and moves
+ *  between quality levels, each of which turns off some optional work. The game loop asks the
+ *  governor what it is allowed to do in the current frame.
+ */
+
+#ifndef MAIN_FRAMEGOVERNOR_H_
+#define MAIN_FRAMEGOVERNOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+
+typedef enum
+{
+	GOVERNOR_LEVEL_FULL,			/* Everything on. */
+	GOVERNOR_LEVEL_REDUCED,			/* Half the stars and particles. */
+	GOVERNOR_LEVEL_PARTIAL,			/* No stars, quarter of the particles, only changed rows are sent to the display. */
+	GOVERNOR_LEVEL_HALF_RATE,		/* As above, and only every other frame is rendered. Game logic still runs every frame. */
+
+	NUMBER_OF_GOVERNOR_LEVELS
+} GovernorLevel_T;
+
+typedef struct
+{
+	uint32_t frames;
+	uint32_t rendered_frames;
+	uint32_t skipped_renders;
+	uint32_t unchanged_frames;
+	uint32_t full_flushes;
+	uint32_t partial_flushes;
+	uint32_t missed_deadlines;
+	uint32_t level_downgrades;
+	uint32_t level_upgrades;
+	uint32_t frames_at_level[NUMBER_OF_GOVERNOR_LEVELS];
+	uint32_t avg_frame_cost_us;
+} GovernorCounters_T;
+
+/* Frame period in RTOS ticks, as the game loop delays. The target frame rate is rounded to whole ticks. */
+#define GOVERNOR_FRAME_PERIOD_TICKS ((TickType_t)((1000u / CONFIG_TARGET_FPS) / portTICK_PERIOD_MS))
+
+/* The same period in microseconds. Budgets and sleeps use this, not the configured rate, so they match the real period. */
+#define GOVERNOR_FRAME_PERIOD_US ((uint32_t)GOVERNOR_FRAME_PERIOD_TICKS * portTICK_PERIOD_MS * 1000u)
+
+_Static_assert(((1000u / CONFIG_TARGET_FPS) / portTICK_PERIOD_MS) > 0u, "Target frame rate is faster than the RTOS tick");
+
+/* Call at the start of every frame, after the frame delay. */
+extern void frameGovernor_frameStart(void);
+
+/* Call at the end of every frame. Updates the cost estimate and the quality level. */
+extern void frameGovernor_frameEnd(void);
+
+/* Whether this frame should be rendered and flushed. */
+extern bool frameGovernor_shouldRender(void);
+
+/* The frame looks the same as the one on the display and was not rendered. Its cost is not averaged. */
+extern void frameGovernor_reportUnchanged(void);
+
+/* Whether the flush may be limited to the changed rows. Caller reports which kind of flush it did. */
+extern bool frameGovernor_isPartialRefreshAllowed(void);
+extern void frameGovernor_reportFlush(bool isPartial);
+
+/* Work limits for the current level. */
+extern uint16_t frameGovernor_getStarCount(uint16_t max_stars);
+extern uint16_t frameGovernor_getParticleBudget(uint16_t max_particles);
+
+extern GovernorLevel_T frameGovernor_getLevel(void);
+extern void frameGovernor_getCounters(GovernorCounters_T * counters);
+extern void frameGovernor_printCounters(void);
+
+#endif /* MAIN_FRAMEGOVERNOR_H_ */
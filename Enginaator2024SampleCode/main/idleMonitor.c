@@ -0,0 +1,146 @@
+/*
+ * idleMonitor.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+
+#include <stdio.h>
+
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+
+#include "idleMonitor.h"
+#include "display.h"
+
+/****************** Private defines *******************/
+
+/* 32-bit FNV-1a */
+#define DIGEST_OFFSET_BASIS	2166136261u
+#define DIGEST_PRIME		16777619u
+
+/* Below this the wakeup costs more than the sleep saves. */
+#define MIN_SLEEP_US		CONFIG_IDLE_MIN_SLEEP_US
+
+/**************** Private function forward declarations **************/
+
+static uint32_t priv_digest(const void * data, size_t size);
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Idle";
+
+static IdleCounters_T priv_counters;
+static uint32_t priv_last_digest = 0u;
+static bool priv_is_digest_valid = false;
+
+/**************** Public functions  **************/
+
+void idleMonitor_init(uint64_t wake_pin_mask)
+{
+#ifdef CONFIG_IDLE_LIGHT_SLEEP
+	for (int pin = 0; pin < GPIO_NUM_MAX; pin++)
+	{
+		if (wake_pin_mask & (1ULL << pin))
+		{
+			ESP_ERROR_CHECK(gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_LOW_LEVEL));
+		}
+	}
+	ESP_ERROR_CHECK(esp_sleep_enable_gpio_wakeup());
+
+	ESP_LOGI(TAG, "Light sleep on idle frames, %d wakeup pins", __builtin_popcountll(wake_pin_mask));
+#else
+	(void)wake_pin_mask;
+#endif
+}
+
+
+bool idleMonitor_isFrameChanged(const void * frame_state, size_t size)
+{
+	uint32_t digest = priv_digest(frame_state, size);
+
+	priv_counters.frames++;
+
+#ifdef CONFIG_IDLE_SKIP_FRAMES
+	if (priv_is_digest_valid && (digest == priv_last_digest))
+	{
+		priv_counters.skipped_frames++;
+		return false;
+	}
+#endif
+
+	priv_last_digest = digest;
+	priv_is_digest_valid = true;
+
+	return true;
+}
+
+
+void idleMonitor_sleepUntil(int64_t wake_time_us)
+{
+#ifdef CONFIG_IDLE_LIGHT_SLEEP
+	int64_t sleep_start_us;
+	int64_t sleep_us;
+
+	/* The SPI peripheral is clock gated in light sleep, nothing may be in flight. */
+	display_waitTransferDone();
+
+	sleep_start_us = esp_timer_get_time();
+	sleep_us = wake_time_us - sleep_start_us;
+
+	if (sleep_us < MIN_SLEEP_US)
+	{
+		return;
+	}
+
+	esp_sleep_enable_timer_wakeup((uint64_t)sleep_us);
+	esp_light_sleep_start();
+
+	priv_counters.sleeps++;
+	priv_counters.sleep_time_us += (uint64_t)(esp_timer_get_time() - sleep_start_us);
+
+	if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO)
+	{
+		priv_counters.gpio_wakeups++;
+	}
+#else
+	/* No light sleep here, the frame delay in the caller idles the CPU. */
+	(void)wake_time_us;
+#endif
+}
+
+
+void idleMonitor_getCounters(IdleCounters_T * counters)
+{
+	*counters = priv_counters;
+}
+
+
+void idleMonitor_printCounters(void)
+{
+	ESP_LOGI(TAG, "Frames %lu, skipped %lu. Sleeps %lu (button wakeups %lu), asleep %llu ms",
+			(unsigned long)priv_counters.frames,
+			(unsigned long)priv_counters.skipped_frames,
+			(unsigned long)priv_counters.sleeps,
+			(unsigned long)priv_counters.gpio_wakeups,
+			(unsigned long long)(priv_counters.sleep_time_us / 1000u));
+}
+
+/*********** Private functions ***********/
+
+static uint32_t priv_digest(const void * data, size_t size)
+{
+	const uint8_t * bytes = (const uint8_t *)data;
+	uint32_t hash = DIGEST_OFFSET_BASIS;
+
+	for (size_t ix = 0; ix < size; ix++)
+	{
+		hash ^= bytes[ix];
+		hash *= DIGEST_PRIME;
+	}
+
+	return hash;
+}
@@ -0,0 +1,41 @@
+/*
+ * idleMonitor.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Detects frames that would look the same as the last one sent to the display, so that both
+ *  rendering and the SPI transfer can be skipped, and puts the CPU into light sleep for the
+ *  rest of such a frame.
+ */
+
+#ifndef MAIN_IDLEMONITOR_H_
+#define MAIN_IDLEMONITOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct
+{
+	uint32_t frames;
+	uint32_t skipped_frames;
+	uint32_t sleeps;
+	uint32_t gpio_wakeups;
+	uint64_t sleep_time_us;
+} IdleCounters_T;
+
+/* The (active low) pins set in the mask, bit n for GPIO n, wake the CPU up from light sleep. */
+extern void idleMonitor_init(uint64_t wake_pin_mask);
+
+/* Digest of everything the frame is drawn from. Returns true if it differs from the last frame that was drawn,
+ * which then becomes the new reference. Returns false for a frame that can be skipped. */
+extern bool idleMonitor_isFrameChanged(const void * frame_state, size_t size);
+
+/* Sleeps until wake_time_us (esp_timer time) or a button press. Waits for display transfers to finish first. */
+extern void idleMonitor_sleepUntil(int64_t wake_time_us);
+
+extern void idleMonitor_getCounters(IdleCounters_T * counters);
+extern void idleMonitor_printCounters(void);
+
+#endif /* MAIN_IDLEMONITOR_H_ */
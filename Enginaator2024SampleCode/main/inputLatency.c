@@ -0,0 +1,326 @@
+/*
+ * inputLatency.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "sdkconfig.h"
+
+#ifdef CONFIG_LATENCY_PROBE
+
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+
+#include "inputLatency.h"
+#include "display.h"
+
+/****************** Private defines *******************/
+
+#define MAX_BUTTONS				8
+
+/* Transitions that have not reached the panel yet. */
+#define MAX_IN_FLIGHT			16
+
+#define HISTOGRAM_BIN_US		500
+#define HISTOGRAM_BINS			256		/* The last bin collects everything above 127.5 ms */
+
+/* The pins are level wakeup sources in light sleep, which rules out edge interrupts on them.
+ * Transitions are then timestamped when the frame reads the buttons. */
+#ifndef CONFIG_IDLE_LIGHT_SLEEP
+#define LATENCY_USE_EDGE_ISR
+#endif
+
+/**************** Private type definitions ******************/
+
+typedef struct
+{
+	int64_t transition_us;
+	uint32_t flush_id;			/* 0 until a flush shows the transition */
+} InFlight_T;
+
+/**************** Private function forward declarations **************/
+
+static void priv_collect(void);
+static void priv_addSample(int64_t latency_us);
+static uint32_t priv_percentile(uint32_t percent);
+#ifdef LATENCY_USE_EDGE_ISR
+static void IRAM_ATTR priv_edgeIsrHandler(void * param);
+#endif
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Latency";
+
+static uint8_t priv_masks[MAX_BUTTONS];
+static int priv_number_of_buttons = 0;
+
+/* First edge of each button since the last button read. Written by the pin interrupt and
+ * taken by the frame under the lock, so a bounce can not move it and a read can not tear it. */
+static int64_t priv_edge_us[MAX_BUTTONS];
+static bool priv_isEdge[MAX_BUTTONS];
+static portMUX_TYPE priv_edge_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t priv_prev_buttons = 0u;
+
+static InFlight_T priv_in_flight[MAX_IN_FLIGHT];
+static int priv_in_flight_count = 0;
+
+static uint32_t priv_histogram[HISTOGRAM_BINS];
+static InputLatencyCounters_T priv_counters;
+
+/**************** Public functions  **************/
+
+void inputLatency_init(const gpio_num_t * pins, const uint8_t * masks, int number_of_buttons)
+{
+	assert(number_of_buttons <= MAX_BUTTONS);
+
+	priv_number_of_buttons = number_of_buttons;
+	memcpy(priv_masks, masks, number_of_buttons);
+	priv_counters.min_us = INT64_MAX;
+
+#ifdef LATENCY_USE_EDGE_ISR
+	/* The service may already be installed by someone else, that is fine. */
+	gpio_install_isr_service(0);
+
+	for (int ix = 0; ix < number_of_buttons; ix++)
+	{
+		ESP_ERROR_CHECK(gpio_set_intr_type(pins[ix], GPIO_INTR_ANYEDGE));
+		ESP_ERROR_CHECK(gpio_isr_handler_add(pins[ix], priv_edgeIsrHandler, (void *)ix));
+	}
+
+	ESP_LOGI(TAG, "Timestamping transitions on %d button pins", number_of_buttons);
+#else
+	(void)pins;
+	ESP_LOGI(TAG, "Timestamping transitions at the button read");
+#endif
+}
+
+
+void inputLatency_sampleInput(uint8_t buttons)
+{
+	int64_t sample_us;
+	int64_t edge_us[MAX_BUTTONS];
+	bool isEdge[MAX_BUTTONS];
+	uint8_t changed = buttons ^ priv_prev_buttons;
+
+	/* Edges after this belong to the next read. */
+	portENTER_CRITICAL(&priv_edge_lock);
+	sample_us = esp_timer_get_time();
+	memcpy(edge_us, priv_edge_us, sizeof(edge_us));
+	memcpy(isEdge, priv_isEdge, sizeof(isEdge));
+	memset(priv_isEdge, 0, sizeof(priv_isEdge));
+	portEXIT_CRITICAL(&priv_edge_lock);
+
+	priv_collect();
+
+	for (int ix = 0; ix < priv_number_of_buttons; ix++)
+	{
+		if ((changed & priv_masks[ix]) == 0u)
+		{
+			continue;
+		}
+
+		/* An edge since the last read is the real transition time. A replayed transition has no edge. */
+		int64_t transition_us = sample_us;
+		if (isEdge[ix])
+		{
+			transition_us = edge_us[ix];
+			priv_counters.edge_timestamps++;
+		}
+
+		priv_counters.transitions++;
+
+		if (priv_in_flight_count < MAX_IN_FLIGHT)
+		{
+			priv_in_flight[priv_in_flight_count].transition_us = transition_us;
+			priv_in_flight[priv_in_flight_count].flush_id = 0u;
+			priv_in_flight_count++;
+		}
+		else
+		{
+			priv_counters.lost++;
+		}
+	}
+
+	priv_prev_buttons = buttons;
+}
+
+
+void inputLatency_frameFlushed(uint32_t flush_id)
+{
+	for (int ix = 0; ix < priv_in_flight_count; ix++)
+	{
+		if (priv_in_flight[ix].flush_id == 0u)
+		{
+			priv_in_flight[ix].flush_id = flush_id;
+		}
+	}
+}
+
+
+void inputLatency_frameUnchanged(void)
+{
+	int kept = 0;
+
+	for (int ix = 0; ix < priv_in_flight_count; ix++)
+	{
+		if (priv_in_flight[ix].flush_id == 0u)
+		{
+			priv_counters.no_effect++;
+		}
+		else
+		{
+			priv_in_flight[kept++] = priv_in_flight[ix];
+		}
+	}
+
+	priv_in_flight_count = kept;
+}
+
+
+void inputLatency_getCounters(InputLatencyCounters_T * counters)
+{
+	priv_collect();
+
+	*counters = priv_counters;
+	counters->p50_us = priv_percentile(50u);
+	counters->p95_us = priv_percentile(95u);
+	counters->p99_us = priv_percentile(99u);
+}
+
+
+void inputLatency_printCounters(void)
+{
+	InputLatencyCounters_T counters;
+	char line[160];
+	int len = 0;
+
+	inputLatency_getCounters(&counters);
+
+	if (counters.samples == 0u)
+	{
+		ESP_LOGI(TAG, "No samples yet, %lu transitions (%lu without effect)",
+				(unsigned long)counters.transitions, (unsigned long)counters.no_effect);
+		return;
+	}
+
+	ESP_LOGI(TAG, "Input to photon %lu samples : min %.1f, p50 %.1f, p95 %.1f, p99 %.1f, max %.1f ms",
+			(unsigned long)counters.samples,
+			counters.min_us / 1000.0, counters.p50_us / 1000.0, counters.p95_us / 1000.0,
+			counters.p99_us / 1000.0, counters.max_us / 1000.0);
+	ESP_LOGI(TAG, "Transitions %lu (%lu edge timestamped), without effect %lu, lost %lu",
+			(unsigned long)counters.transitions, (unsigned long)counters.edge_timestamps,
+			(unsigned long)counters.no_effect, (unsigned long)counters.lost);
+
+	/* The whole distribution, as "upper edge in us:count" pairs of the non-empty bins. */
+	for (int bin = 0; bin < HISTOGRAM_BINS; bin++)
+	{
+		if (priv_histogram[bin] == 0u)
+		{
+			continue;
+		}
+
+		len += snprintf(&line[len], sizeof(line) - len, " %d:%lu", (bin + 1) * HISTOGRAM_BIN_US, (unsigned long)priv_histogram[bin]);
+		if (len > (int)(sizeof(line) - 24))
+		{
+			ESP_LOGI(TAG, "Histogram%s", line);
+			len = 0;
+		}
+	}
+
+	if (len > 0)
+	{
+		ESP_LOGI(TAG, "Histogram%s", line);
+	}
+}
+
+/*********** Private functions ***********/
+
+/* Turns the transitions whose flush has been sent into samples. Flushes complete in order. */
+static void priv_collect(void)
+{
+	int kept = 0;
+	int64_t done_us;
+
+	for (int ix = 0; ix < priv_in_flight_count; ix++)
+	{
+		InFlight_T * entry = &priv_in_flight[ix];
+
+		if ((entry->flush_id != 0u) && display_getFlushDoneTime(entry->flush_id, &done_us))
+		{
+			if (done_us == 0)
+			{
+				priv_counters.lost++;
+			}
+			else
+			{
+				priv_addSample(done_us - entry->transition_us);
+			}
+		}
+		else
+		{
+			priv_in_flight[kept++] = *entry;
+		}
+	}
+
+	priv_in_flight_count = kept;
+}
+
+
+static void priv_addSample(int64_t latency_us)
+{
+	int bin = (int)(latency_us / HISTOGRAM_BIN_US);
+
+	bin = MIN(MAX(bin, 0), HISTOGRAM_BINS - 1);
+	priv_histogram[bin]++;
+
+	priv_counters.samples++;
+	priv_counters.min_us = MIN(priv_counters.min_us, latency_us);
+	priv_counters.max_us = MAX(priv_counters.max_us, latency_us);
+}
+
+
+/* Upper edge of the bin that holds the given percentile. */
+static uint32_t priv_percentile(uint32_t percent)
+{
+	uint32_t rank = ((priv_counters.samples * percent) + 99u) / 100u;
+	uint32_t count = 0u;
+
+	for (int bin = 0; bin < HISTOGRAM_BINS; bin++)
+	{
+		count += priv_histogram[bin];
+		if ((count >= rank) && (count > 0u))
+		{
+			return (uint32_t)((bin + 1) * HISTOGRAM_BIN_US);
+		}
+	}
+
+	return 0u;
+}
+
+
+#ifdef LATENCY_USE_EDGE_ISR
+static void IRAM_ATTR priv_edgeIsrHandler(void * param)
+{
+	int ix = (int)param;
+	int64_t now_us = esp_timer_get_time();
+
+	/* Contact bounce gives more edges, only the first one is the transition. */
+	portENTER_CRITICAL_ISR(&priv_edge_lock);
+	if (!priv_isEdge[ix])
+	{
+		priv_edge_us[ix] = now_us;
+		priv_isEdge[ix] = true;
+	}
+	portEXIT_CRITICAL_ISR(&priv_edge_lock);
+}
+#endif
+
+#endif /* CONFIG_LATENCY_PROBE */
@@ -0,0 +1,49 @@
+/*
+ * inputLatency.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Input to photon latency measurement. Every button transition is timestamped, the first
+ *  flush that shows its result is tagged, and the time from the transition to the end of that
+ *  flush's last SPI transaction goes into a histogram.
+ */
+
+#ifndef MAIN_INPUTLATENCY_H_
+#define MAIN_INPUTLATENCY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "driver/gpio.h"
+
+typedef struct
+{
+	uint32_t transitions;
+	uint32_t samples;			/* Transitions that reached the panel */
+	uint32_t no_effect;			/* Transitions that did not change the picture */
+	uint32_t lost;				/* Dropped because too many were in flight, or the flush was too old to look up */
+	uint32_t edge_timestamps;	/* Transitions timestamped by the pin interrupt, the rest at the frame's button read */
+	int64_t min_us;
+	int64_t max_us;
+	uint32_t p50_us;
+	uint32_t p95_us;
+	uint32_t p99_us;
+} InputLatencyCounters_T;
+
+/* Button i is active low on pins[i] and has the bit masks[i] in the button state. */
+extern void inputLatency_init(const gpio_num_t * pins, const uint8_t * masks, int number_of_buttons);
+
+/* Called with the button state right after it has been read for a frame. */
+extern void inputLatency_sampleInput(uint8_t buttons);
+
+/* The transitions so far are shown by the given flush (display_getFlushId). */
+extern void inputLatency_frameFlushed(uint32_t flush_id);
+
+/* The frame looks the same as the one on the display, so the transitions so far had no visible effect. */
+extern void inputLatency_frameUnchanged(void);
+
+extern void inputLatency_getCounters(InputLatencyCounters_T * counters);
+extern void inputLatency_printCounters(void);
+
+#endif /* MAIN_INPUTLATENCY_H_ */
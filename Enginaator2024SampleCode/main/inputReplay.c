@@ -0,0 +1,180 @@
+/*
+ * inputReplay.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+
+#include "inputReplay.h"
+
+/****************** Private defines *******************/
+
+#define REPLAY_FILE_MAGIC   0x43455245u  /* "EREC" */
+#define REPLAY_FILE_VERSION 1u
+
+/* Recorded frames are flushed to the card this often, so little is lost when the unit is switched off. */
+#define RECORD_FLUSH_INTERVAL 64u
+
+/****************** Private type definitions *******************/
+
+typedef enum
+{
+	REPLAY_STATE_OFF,
+	REPLAY_STATE_RECORDING,
+	REPLAY_STATE_PLAYING,
+} ReplayState_T;
+
+#pragma pack(push)
+#pragma pack(1)
+/* The file is this header followed by one byte of button state per frame. */
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t reserved;
+	uint32_t seed;
+} ReplayFileHeader_T;
+#pragma pack(pop)
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Input Replay";
+
+static ReplayState_T priv_state = REPLAY_STATE_OFF;
+static FILE * priv_file = NULL;
+static uint32_t priv_seed = 1u;
+static uint32_t priv_frame_count = 0u;
+static int64_t priv_start_time_us = 0;
+
+/**************** Public functions  **************/
+
+void inputReplay_init(void)
+{
+	ReplayFileHeader_T header;
+
+	priv_seed = esp_random();
+
+#if defined(CONFIG_INPUT_REPLAY_RECORD)
+	priv_file = fopen(CONFIG_INPUT_REPLAY_FILE, "wb");
+
+	if (priv_file == NULL)
+	{
+		ESP_LOGE(TAG, "Failed to open %s for writing", CONFIG_INPUT_REPLAY_FILE);
+		return;
+	}
+
+	memset(&header, 0, sizeof(header));
+	header.magic = REPLAY_FILE_MAGIC;
+	header.version = REPLAY_FILE_VERSION;
+	header.seed = priv_seed;
+	fwrite(&header, sizeof(header), 1u, priv_file);
+
+	priv_state = REPLAY_STATE_RECORDING;
+	ESP_LOGI(TAG, "Recording input to %s, seed %lu", CONFIG_INPUT_REPLAY_FILE, (unsigned long)priv_seed);
+
+#elif defined(CONFIG_INPUT_REPLAY_PLAYBACK)
+	priv_file = fopen(CONFIG_INPUT_REPLAY_FILE, "rb");
+
+	if (priv_file == NULL)
+	{
+		ESP_LOGE(TAG, "Failed to open %s for reading", CONFIG_INPUT_REPLAY_FILE);
+		return;
+	}
+
+	if ((fread(&header, sizeof(header), 1u, priv_file) != 1u) || (header.magic != REPLAY_FILE_MAGIC) || (header.version != REPLAY_FILE_VERSION))
+	{
+		ESP_LOGE(TAG, "%s is not a valid recording", CONFIG_INPUT_REPLAY_FILE);
+		fclose(priv_file);
+		priv_file = NULL;
+		return;
+	}
+
+	priv_seed = header.seed;
+	priv_state = REPLAY_STATE_PLAYING;
+	ESP_LOGI(TAG, "Replaying input from %s, seed %lu", CONFIG_INPUT_REPLAY_FILE, (unsigned long)priv_seed);
+#else
+	(void)header;
+#endif
+}
+
+
+uint32_t inputReplay_getSeed(void)
+{
+	return priv_seed;
+}
+
+
+uint8_t inputReplay_processFrame(uint8_t live_buttons)
+{
+	uint8_t buttons = live_buttons;
+
+	switch(priv_state)
+	{
+	case REPLAY_STATE_RECORDING:
+		fwrite(&buttons, sizeof(buttons), 1u, priv_file);
+		priv_frame_count++;
+
+		if ((priv_frame_count % RECORD_FLUSH_INTERVAL) == 0u)
+		{
+			fflush(priv_file);
+		}
+		break;
+
+	case REPLAY_STATE_PLAYING:
+		/* Timed from the first replayed frame, so the splash screen and the intro are not included. */
+		if (priv_frame_count == 0u)
+		{
+			priv_start_time_us = esp_timer_get_time();
+		}
+
+		if (fread(&buttons, sizeof(buttons), 1u, priv_file) == 1u)
+		{
+			priv_frame_count++;
+		}
+		else
+		{
+			/* End of the recording, report the result and fall back to live input. */
+			int64_t elapsed_us = esp_timer_get_time() - priv_start_time_us;
+
+			ESP_LOGI(TAG, "Replay finished : %lu frames in %lld ms, %lld us per frame",
+					(unsigned long)priv_frame_count,
+					(long long)(elapsed_us / 1000),
+					(long long)(priv_frame_count > 0u ? (elapsed_us / priv_frame_count) : 0));
+
+			fclose(priv_file);
+			priv_file = NULL;
+			priv_state = REPLAY_STATE_OFF;
+			buttons = live_buttons;
+		}
+		break;
+
+	case REPLAY_STATE_OFF:
+	default:
+		break;
+	}
+
+	return buttons;
+}
+
+
+bool inputReplay_isPlaying(void)
+{
+	return (priv_state == REPLAY_STATE_PLAYING);
+}
+
+
+bool inputReplay_isUnthrottled(void)
+{
+#ifdef CONFIG_INPUT_REPLAY_UNTHROTTLED
+	return (priv_state == REPLAY_STATE_PLAYING);
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,32 @@
+/*
+ * inputReplay.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Records the button state of every frame and the random seed to a file, or feeds
+ *  a recording back into the game instead of the live buttons. Mode is selected in menuconfig.
+ */
+
+#ifndef MAIN_INPUTREPLAY_H_
+#define MAIN_INPUTREPLAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Opens the recording file. Must be called after the SD card has been mounted. */
+extern void inputReplay_init(void);
+
+/* Seed for the random generator. Stored in the recording, so a replay gets the same starfield. */
+extern uint32_t inputReplay_getSeed(void);
+
+/* Called once per frame with the live button state. Returns the button state that the game should use. */
+extern uint8_t inputReplay_processFrame(uint8_t live_buttons);
+
+/* True while a recording is being played back. */
+extern bool inputReplay_isPlaying(void);
+
+/* True while a replay is running with the frame rate limit disabled. */
+extern bool inputReplay_isUnthrottled(void);
+
+#endif /* MAIN_INPUTREPLAY_H_ */
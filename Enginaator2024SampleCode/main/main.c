@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <unistd.h>
+#include <string.h>
 #include "driver/gpio.h"
 
 #include "esp_timer.h"
@@ -9,6 +10,19 @@
 
 #include "display.h"
 #include "sdCard.h"
+#include "inputReplay.h"
+#include "memPool.h"
+#include "particles.h"
+#include "frameGovernor.h"
+#include "bootSeq.h"
+#include "trace.h"
+#include "renderBands.h"
+#include "teSync.h"
+#include "idleMonitor.h"
+#include "videoPlayer.h"
+#include "inputLatency.h"
+#include "waves.h"
+#include "frameCapture.h"
 
 /* Private defines */
 
@@ -22,6 +36,55 @@
 
 #define BUTTON_TRIGGER 	40u
 
+/* Bits of the button state that is read once per frame. */
+#define BUTTON_MASK_UP		(1u << 0)
+#define BUTTON_MASK_DOWN	(1u << 1)
+#define BUTTON_MASK_RIGHT	(1u << 2)
+#define BUTTON_MASK_LEFT	(1u << 3)
+#define BUTTON_MASK_TRIGGER	(1u << 4)
+
+/* Pressing left and right together pauses and resumes the game. */
+#define BUTTON_MASK_PAUSE	(BUTTON_MASK_LEFT | BUTTON_MASK_RIGHT)
+/* Pressing up and down together captures the screen to the SD card. */
+#define BUTTON_MASK_CAPTURE	(BUTTON_MASK_UP | BUTTON_MASK_DOWN)
+
+#define FRAME_BUFFER_SIZE (DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(uint16_t))
+
+/* Budget for everything that is loaded per level. */
+#define LEVEL_ARENA_SIZE ((16u * 1024u) + WAVES_ARENA_SIZE)
+
+#define SHIP_BUF_WIDTH	60u
+#define SHIP_BUF_HEIGHT	60u
+
+/* Effects live for the whole run, so they get their own arena. About 13 bytes per particle. */
+#define EFFECTS_ARENA_SIZE (CONFIG_PARTICLE_POOL_SIZE * 16u)
+
+#define EXPLOSION_PARTICLES	400u
+#define THRUST_PARTICLES	12u
+
+#define TARGET_SIZE 20
+
+/* Targets sit where they did on the 320 pixel wide default panel, the right one measured from the right edge. */
+#define TARGET_LEFT_X	10
+#define TARGET_RIGHT_X	((int)DISPLAY_WIDTH - 110)
+
+/* Pause symbol : two bars around the middle of the screen. */
+#define PAUSE_BAR_WIDTH		8
+#define PAUSE_BAR_HEIGHT	40
+#define PAUSE_BAR_LEFT_X	(((int)DISPLAY_WIDTH / 2) - 12)
+#define PAUSE_BAR_RIGHT_X	(((int)DISPLAY_WIDTH / 2) + 4)
+#define PAUSE_BAR_Y			(((int)DISPLAY_HEIGHT / 2) - (PAUSE_BAR_HEIGHT / 2))
+
+/* The game loop runs above the default app_main priority, so the capture writer only gets the time it leaves over.
+ * The render workers run at the same priority. */
+#define GAME_LOOP_PRIORITY 2u
+
+/* The splash image is sent to the display in bands of this many rows while it loads. */
+#define SPLASH_BAND_ROWS 24
+
+/* Governor counters are logged this often. */
+#define GOVERNOR_REPORT_INTERVAL_FRAMES (10u * CONFIG_TARGET_FPS)
+
 /* For the S3 board: */
 #define PIN_NUM_CLK   12
 #define PIN_NUM_MOSI  11
@@ -29,6 +92,20 @@
 
 /* Private type definitions */
 
+/* Everything a frame is drawn from. If this is the same as for the last drawn frame, the frame would look the same. */
+typedef struct
+{
+	int yLocation;
+	int ship_x;
+	int ship_y;
+	int bullet_x;
+	int bullet_y;
+	uint32_t world_tick;
+	uint32_t star_count;
+	uint32_t particle_count;
+	uint32_t enemy_count;
+	uint32_t is_paused;
+} FrameState_T;
 
 /* Private function forward declarations */
 static void configure_led(void);
@@ -44,10 +121,23 @@ static void flushFrameBuffer(void);
 static void drawBackGround(void);
 static void drawStar(uint16_t xPos, uint16_t yPos);
 static void drawBullet(uint16_t xPos, uint16_t yPos);
+static void addDirtyRows(int yPos, int height);
+static void updateStars(void);
+static void getFrameState(FrameState_T * state);
 
 void timer_callback_10msec(void *param);
 
 static void init_buttons(void);
+static bool isBulletInTarget(int xPos, int yPos);
+static void loadLevelAssets(void);
+
+static void boot_initPanel(void);
+static void boot_initSdCard(void);
+static void boot_showSplash(void);
+static void boot_loadAssets(void);
+static void splashRowsReady(int first_row, int number_of_rows);
+static uint8_t read_buttons(void);
+static void playIntro(void);
 
 /* Private variables */
 volatile bool timer_flag = false;
@@ -56,16 +146,32 @@ static const char *TAG = "Main Program";
 
 static int yLocation = 0;
 static int ship_y = 90;
-static int ship_x = 240;
+static int ship_x = DISPLAY_WIDTH - 80;
 
-static int bullet_x = 320;
-static int bullet_y = 240;
+static int bullet_x = DISPLAY_WIDTH;
+static int bullet_y = DISPLAY_HEIGHT;
 
 const static int ship_speed = 3u;
 
 static bool direction = true;
 static int speed = 4;
 
+/* Button state of the current frame, either live or from a replay. */
+static uint8_t priv_buttons = 0u;
+static uint8_t priv_prev_buttons = 0u;
+
+/* While paused nothing moves, so the idle monitor skips the frames and the CPU sleeps. */
+static bool priv_is_paused = false;
+
+/* Advances on every frame where the game is not paused. */
+static uint32_t priv_world_tick = 0u;
+
+/* Rows changed by the frame being drawn, and by the frame that was last sent to the display. Used for partial flushes. */
+static int priv_dirty_y0;
+static int priv_dirty_y1;
+static int priv_flushed_dirty_y0 = 0;
+static int priv_flushed_dirty_y1 = DISPLAY_HEIGHT - 1;
+
 #define ENABLE_DOUBLE_BUFFERING
 
 //uint16_t priv_frame_buffer[240][320];
@@ -80,55 +186,101 @@ uint16_t ** priv_curr_frame_buffer;
 /* Cached visual elements. */
 uint16_t * ship_buf;
 
+/* Frame buffers live for the whole run, level assets are released together when the level changes.
+ * Each frame buffer has an arena of its own, a single block for both would rarely fit in the DMA capable RAM. */
+static MemPoolArena_T * priv_frame_arena1;
+#ifdef ENABLE_DOUBLE_BUFFERING
+static MemPoolArena_T * priv_frame_arena2;
+#endif
+static MemPoolArena_T * priv_level_arena;
+static MemPoolArena_T * priv_effects_arena;
+#ifdef CONFIG_CAPTURE_ENABLE
+static MemPoolArena_T * priv_capture_arena;
+#endif
+
+/* Boot steps. Panel and SD card share the SPI bus, but both spend most of their time waiting, so they run side by side. */
+enum
+{
+	BOOT_STEP_PANEL,
+	BOOT_STEP_SD_CARD,
+	BOOT_STEP_SPLASH,
+	BOOT_STEP_ASSETS,
+
+	NUMBER_OF_BOOT_STEPS
+};
+
+static const BootStep_T priv_boot_steps[NUMBER_OF_BOOT_STEPS] =
+{
+	[BOOT_STEP_PANEL] 	= { "panel",  boot_initPanel,  0u },
+	[BOOT_STEP_SD_CARD] = { "sdcard", boot_initSdCard, 0u },
+	[BOOT_STEP_SPLASH] 	= { "splash", boot_showSplash, BOOT_STEP_BIT(BOOT_STEP_PANEL) | BOOT_STEP_BIT(BOOT_STEP_SD_CARD) },
+	[BOOT_STEP_ASSETS] 	= { "assets", boot_loadAssets, BOOT_STEP_BIT(BOOT_STEP_SD_CARD) },
+};
+
 /* Public functions */
 void app_main(void)
 {
 	printf("Starting program...\n");
     ESP_LOGI("memory", "Total available memory: %u bytes", heap_caps_get_total_size(MALLOC_CAP_8BIT));
 
-    priv_frame_buffer1 = heap_caps_malloc(240*320*sizeof(uint16_t), MALLOC_CAP_DMA);
+    priv_frame_arena1 = memPool_createArena("frame1", MEMPOOL_REGION_DMA, FRAME_BUFFER_SIZE);
+    assert(priv_frame_arena1);
+
+#ifdef ENABLE_DOUBLE_BUFFERING
+    priv_frame_arena2 = memPool_createArena("frame2", MEMPOOL_REGION_DMA, FRAME_BUFFER_SIZE);
+    assert(priv_frame_arena2);
+#endif
+
+    priv_level_arena = memPool_createArena("level", MEMPOOL_REGION_INTERNAL, LEVEL_ARENA_SIZE);
+    assert(priv_level_arena);
+
+    priv_effects_arena = memPool_createArena("effects", MEMPOOL_REGION_PSRAM, EFFECTS_ARENA_SIZE);
+    assert(priv_effects_arena);
+
+#ifdef CONFIG_CAPTURE_ENABLE
+    priv_capture_arena = memPool_createArena("capture", MEMPOOL_REGION_PSRAM, FRAME_CAPTURE_ARENA_SIZE);
+    assert(priv_capture_arena);
+#endif
+
+    priv_frame_buffer1 = memPool_alloc(priv_frame_arena1, FRAME_BUFFER_SIZE);
     assert(priv_frame_buffer1);
 
 #ifdef ENABLE_DOUBLE_BUFFERING
-    priv_frame_buffer2 = heap_caps_malloc(240*320*sizeof(uint16_t), MALLOC_CAP_DMA);
+    priv_frame_buffer2 = memPool_alloc(priv_frame_arena2, FRAME_BUFFER_SIZE);
     assert(priv_frame_buffer2);
 #endif
 
     priv_curr_frame_buffer = &priv_frame_buffer1;
 
+    trace_init();
+    renderBands_init();
+
 	configure_led();
 
 	init_buttons();
 
-	configure_timer();
+	idleMonitor_init((1ULL << BUTTON_UP) | (1ULL << BUTTON_DOWN) | (1ULL << BUTTON_RIGHT) | (1ULL << BUTTON_LEFT) | (1ULL << BUTTON_TRIGGER));
 
-	configure_spi();
-
-	sdCard_init();
+#ifdef CONFIG_LATENCY_PROBE
+	static const gpio_num_t wake_pins[] = { BUTTON_UP, BUTTON_DOWN, BUTTON_RIGHT, BUTTON_LEFT, BUTTON_TRIGGER };
+	static const uint8_t button_masks[] = { BUTTON_MASK_UP, BUTTON_MASK_DOWN, BUTTON_MASK_RIGHT, BUTTON_MASK_LEFT, BUTTON_MASK_TRIGGER };
+	inputLatency_init(wake_pins, button_masks, sizeof(wake_pins) / sizeof(wake_pins[0]));
+#endif
 
-	/* Initialize the main display. */
-	display_init();
-	display_fillRectangle(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, COLOR_BLUE);
+	configure_timer();
 
-	vTaskDelay(1000 / portTICK_PERIOD_MS);
+	configure_spi();
 
-	sdCard_Read_bmp_file("/test.bmp", *priv_curr_frame_buffer);
+	bootSeq_run(priv_boot_steps, NUMBER_OF_BOOT_STEPS);
 
-	ship_buf = heap_caps_malloc(60*60*sizeof(uint16_t), MALLOC_CAP_DMA);
-	sdCard_Read_bmp_file("/ship.bmp", ship_buf);
+#ifdef CONFIG_CAPTURE_ENABLE
+	/* The card is mounted by now. */
+	frameCapture_init(priv_capture_arena);
+#endif
 
-	display_drawScreenBuffer(*priv_curr_frame_buffer);
+#ifdef CONFIG_BOOT_DEMO_SEQUENCE
 	vTaskDelay(2000 / portTICK_PERIOD_MS);
 
-
-	for(int x = 0; x < 60*60; x++)
-	{
-		if (ship_buf[x] == 0xffffu)
-		{
-			ship_buf[x] = BACKGROUND_COLOR;
-		}
-	}
-
 	vTaskDelay(400 / portTICK_PERIOD_MS);
 	display_fillRectangle(0, 0, 60, 40, COLOR_RED);
 	vTaskDelay(400 / portTICK_PERIOD_MS);
@@ -145,45 +297,143 @@ void app_main(void)
 
 
 	vTaskDelay(1000 / portTICK_PERIOD_MS);
+#endif
+
+	/* The last band of the splash may still be on its way from frame buffer 1, the player reads into it. */
+	display_waitTransferDone();
+	playIntro();
+
+	memPool_printStats();
 
 	/* Lets try something dynamic now... */
 
 
 	TickType_t xLastWakeTime;
-	const TickType_t xFrequency = 40u / portTICK_PERIOD_MS;
+	const TickType_t xFrequency = GOVERNOR_FRAME_PERIOD_TICKS;
 
+	vTaskPrioritySet(NULL, GAME_LOOP_PRIORITY);
 	xLastWakeTime = xTaskGetTickCount ();
 
 #ifdef ENABLE_DOUBLE_BUFFERING
 	bool isBufferOne = true;
 #endif
+	uint32_t frame_count = 0u;
+	int64_t frame_start_us;
+	FrameState_T frame_state;
+	bool isRender;
+	bool isSleep;
 
 	while(1)
 	{
-		vTaskDelayUntil( &xLastWakeTime, xFrequency );
-
-#ifdef ENABLE_DOUBLE_BUFFERING
-		/* Switch the buffer - here we implement double buffering. */
-		if (isBufferOne)
+		if (inputReplay_isUnthrottled())
 		{
-			priv_curr_frame_buffer = &priv_frame_buffer2;
-			isBufferOne = false;
+			/* Benchmark replay, run as fast as we can. */
+			xLastWakeTime = xTaskGetTickCount();
 		}
 		else
 		{
-			priv_curr_frame_buffer = &priv_frame_buffer1;
-			isBufferOne = true;
+			vTaskDelayUntil( &xLastWakeTime, xFrequency );
 		}
+
+		frame_start_us = esp_timer_get_time();
+		TRACE_BEGIN("frame");
+		frameGovernor_frameStart();
+		particles_setBudget(frameGovernor_getParticleBudget(CONFIG_PARTICLE_POOL_SIZE));
+
+		/* Buttons are sampled once per frame, so a recording can reproduce them exactly. */
+		priv_buttons = inputReplay_processFrame(read_buttons());
+#ifdef CONFIG_LATENCY_PROBE
+		inputLatency_sampleInput(priv_buttons);
 #endif
 
 		/*Here we update things like the location of the elements. Later we will check for buttons etc. */
 		updateDisplayedElements();
 
-		/*Here we draw into the frame buffer. */
-		updateFrameBuffer();
+		/* Under heavy load the governor can skip rendering, the game logic above still runs every frame.
+		 * Frames that would look the same as the one on the display are not rendered or sent either. */
+		isRender = frameGovernor_shouldRender();
+		if (isRender)
+		{
+			getFrameState(&frame_state);
+			isRender = idleMonitor_isFrameChanged(&frame_state, sizeof(frame_state));
+			if (!isRender)
+			{
+				frameGovernor_reportUnchanged();
+#ifdef CONFIG_LATENCY_PROBE
+				inputLatency_frameUnchanged();
+#endif
+#ifdef CONFIG_CAPTURE_ENABLE
+				/* Nothing is flushed while the picture stays the same, for example while paused.
+				 * The display still shows the current buffer, so a requested capture is taken from it. */
+				frameCapture_onFlush(*priv_curr_frame_buffer, priv_world_tick);
+#endif
+			}
+		}
+
+		if (isRender)
+		{
+#ifdef ENABLE_DOUBLE_BUFFERING
+			/* Switch the buffer - here we implement double buffering. */
+			if (isBufferOne)
+			{
+				priv_curr_frame_buffer = &priv_frame_buffer2;
+				isBufferOne = false;
+			}
+			else
+			{
+				priv_curr_frame_buffer = &priv_frame_buffer1;
+				isBufferOne = true;
+			}
+#endif
+
+			/*Here we draw into the frame buffer. */
+			updateFrameBuffer();
+
+			/* Here we send the frame buffer to be drawn by the display driver. */
+			flushFrameBuffer();
+#ifdef CONFIG_LATENCY_PROBE
+			inputLatency_frameFlushed(display_getFlushId());
+#endif
+		}
+
+		frameGovernor_frameEnd();
+		bootSeq_markInteractive();
+		TRACE_END("frame");
+
+		isSleep = !isRender && !inputReplay_isUnthrottled();
+#ifdef CONFIG_CAPTURE_ENABLE
+		/* The card is on the SPI bus, which light sleep clock gates. */
+		isSleep = isSleep && !frameCapture_isBusy();
+#endif
+
+		if (isSleep)
+		{
+			/* Nothing to do until the next frame, or until a button is pressed. */
+			idleMonitor_sleepUntil(frame_start_us + GOVERNOR_FRAME_PERIOD_US);
+		}
+
+		frame_count++;
+		if ((frame_count % GOVERNOR_REPORT_INTERVAL_FRAMES) == 0u)
+		{
+			frameGovernor_printCounters();
+			idleMonitor_printCounters();
+#ifdef CONFIG_DISPLAY_TE_SYNC
+			teSync_printCounters();
+#endif
+#ifdef CONFIG_LATENCY_PROBE
+			inputLatency_printCounters();
+#endif
+#ifdef CONFIG_CAPTURE_ENABLE
+			frameCapture_printCounters();
+#endif
+		}
 
-		/* Here we send the frame buffer to be drawn by the display driver. */
-		flushFrameBuffer();
+#ifdef CONFIG_TRACE_ENABLE
+		if (frame_count == CONFIG_TRACE_DUMP_AFTER_FRAMES)
+		{
+			trace_dumpToFile();
+		}
+#endif
 	}
 
 	printf("System idle Process...\n");
@@ -196,42 +446,45 @@ void app_main(void)
 	}
 }
 
-#define SET_FRAME_BUF_PIXEL(buf,x,y,color) *((buf) + (x) + (320*(y)))=color
-
+/* Drawing only records commands, the frame buffer is written in renderBands_execute, split across both cores. */
 static void drawRectangleInFrameBuf(int xPos, int yPos, int width, int height, uint16_t color)
 {
-	for (int x = xPos; ((x < (xPos+width)) && (x < 320)); x++)
-	{
-		for (int y = yPos; ((y < (yPos+height)) && (y < 240)); y++)
-		{
-			//priv_frame_buffer[y][x] = color;
-			SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, x, y, color);
-		}
-	}
+	renderBands_fillRect(xPos, yPos, width, height, color);
 }
 
+/* The bitmap data is stored column by column. */
 static void drawBmpInFrameBuf(int xPos, int yPos, int width, int height, uint16_t * data_buf)
 {
-	uint16_t * data_ptr = data_buf;
-
-	for (int x = xPos; (x < (xPos + width)); x++)
-	{
-		for (int y = yPos; (y < (yPos + height)); y++)
-		{
-			if ((x >= 0) && (x < DISPLAY_WIDTH) && (y >= 0) && (y < DISPLAY_HEIGHT))
-			{
-				SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, x, y, *data_ptr);
-			}
-			data_ptr++;
-		}
-	}
+	renderBands_blitColumns(xPos, yPos, width, height, data_buf);
 }
 
 static void updateDisplayedElements()
 {
+	TRACE_SCOPE("updateDisplayedElements");
+
+	if (((priv_buttons & BUTTON_MASK_PAUSE) == BUTTON_MASK_PAUSE) && ((priv_prev_buttons & BUTTON_MASK_PAUSE) != BUTTON_MASK_PAUSE))
+	{
+		priv_is_paused = !priv_is_paused;
+	}
+#ifdef CONFIG_CAPTURE_ENABLE
+	if (((priv_buttons & BUTTON_MASK_CAPTURE) == BUTTON_MASK_CAPTURE) && ((priv_prev_buttons & BUTTON_MASK_CAPTURE) != BUTTON_MASK_CAPTURE))
+	{
+		frameCapture_request();
+	}
+#endif
+	priv_prev_buttons = priv_buttons;
+
+	if (priv_is_paused)
+	{
+		return;
+	}
+
+	priv_world_tick++;
+	updateStars();
+
 	if(direction)
 	{
-		if(yLocation >= 184u)
+		if(yLocation >= (DISPLAY_HEIGHT - 56u))
 		{
 			yLocation-= speed;
 			direction = false;
@@ -254,14 +507,17 @@ static void updateDisplayedElements()
 		}
 	}
 
-	if (gpio_get_level(BUTTON_UP) == 0)
+	if (priv_buttons & BUTTON_MASK_UP)
 	{
 		if(ship_x > 0)
 		{
 			ship_x -= ship_speed;
+
+			/* Engine exhaust from the back of the ship. */
+			particles_emitThrust(ship_x + 40, ship_y + 26, THRUST_PARTICLES);
 		}
 	}
-	else if(gpio_get_level(BUTTON_DOWN) == 0)
+	else if (priv_buttons & BUTTON_MASK_DOWN)
 	{
 		if(ship_x < DISPLAY_WIDTH)
 		{
@@ -269,14 +525,14 @@ static void updateDisplayedElements()
 		}
 	}
 
-	else if(gpio_get_level(BUTTON_RIGHT) == 0)
+	else if (priv_buttons & BUTTON_MASK_RIGHT)
 	{
 		if(ship_y > 0)
 		{
 			ship_y-= ship_speed;
 		}
 	}
-	else if(gpio_get_level(BUTTON_LEFT) == 0)
+	else if (priv_buttons & BUTTON_MASK_LEFT)
 	{
 		if(ship_y < DISPLAY_HEIGHT)
 		{
@@ -284,7 +540,7 @@ static void updateDisplayedElements()
 		}
 	}
 
-	if (gpio_get_level(BUTTON_TRIGGER) == 0)
+	if (priv_buttons & BUTTON_MASK_TRIGGER)
 	{
 		if (bullet_x <= 0)
 		{
@@ -296,33 +552,174 @@ static void updateDisplayedElements()
 	if(bullet_x > 0)
 	{
 		bullet_x -= 6u;
+
+		if (isBulletInTarget(bullet_x, bullet_y) || waves_hitTest(bullet_x, bullet_y))
+		{
+			particles_emitExplosion(bullet_x, bullet_y, EXPLOSION_PARTICLES);
+			bullet_x = 0;
+		}
 	}
+
+	waves_update();
+	particles_update();
 }
 
 
 static void updateFrameBuffer(void)
 {
+	TRACE_SCOPE("updateFrameBuffer");
+	ParticleBounds_T particle_bounds;
+	int enemy_y0, enemy_y1;
+
+	priv_dirty_y0 = DISPLAY_HEIGHT;
+	priv_dirty_y1 = -1;
+
+	renderBands_begin(*priv_curr_frame_buffer);
+
 	/* Draw the whole background */
 	drawBackGround();
 
 	/* Draw Elements */
+	particles_getBounds(&particle_bounds);
+	if (particle_bounds.is_valid)
+	{
+		renderBands_callback(particle_bounds.y0, (particle_bounds.y1 - particle_bounds.y0) + 1, particles_renderRows);
+		addDirtyRows(particle_bounds.y0, (particle_bounds.y1 - particle_bounds.y0) + 1);
+	}
+
+	if (waves_getRows(&enemy_y0, &enemy_y1))
+	{
+		renderBands_callback(enemy_y0, (enemy_y1 - enemy_y0) + 1, waves_renderRows);
+		addDirtyRows(enemy_y0, (enemy_y1 - enemy_y0) + 1);
+	}
+
 	drawBmpInFrameBuf(ship_x, ship_y, 40, 53, ship_buf);
+	addDirtyRows(ship_y, 53);
 
 	drawBullet(bullet_x, bullet_y);
+	addDirtyRows(bullet_y - 1, 3);
 
-	drawRectangleInFrameBuf(10,  240 - yLocation - 40, 20, 20, COLOR_GREEN);
-	drawRectangleInFrameBuf(210, 240 - yLocation - 40, 20, 20, COLOR_MAGENTA);
+	drawRectangleInFrameBuf(TARGET_LEFT_X,  (int)DISPLAY_HEIGHT - yLocation - 40, TARGET_SIZE, TARGET_SIZE, COLOR_GREEN);
+	drawRectangleInFrameBuf(TARGET_RIGHT_X, (int)DISPLAY_HEIGHT - yLocation - 40, TARGET_SIZE, TARGET_SIZE, COLOR_MAGENTA);
+	addDirtyRows((int)DISPLAY_HEIGHT - yLocation - 40, TARGET_SIZE);
+
+	if (priv_is_paused)
+	{
+		/* Pause symbol in the middle of the screen. */
+		drawRectangleInFrameBuf(PAUSE_BAR_LEFT_X,  PAUSE_BAR_Y, PAUSE_BAR_WIDTH, PAUSE_BAR_HEIGHT, COLOR_WHITE);
+		drawRectangleInFrameBuf(PAUSE_BAR_RIGHT_X, PAUSE_BAR_Y, PAUSE_BAR_WIDTH, PAUSE_BAR_HEIGHT, COLOR_WHITE);
+		addDirtyRows(PAUSE_BAR_Y, PAUSE_BAR_HEIGHT);
+	}
+
+	renderBands_execute();
 }
 
 
 static void flushFrameBuffer(void)
 {
-	display_drawScreenBuffer(*priv_curr_frame_buffer);
+	TRACE_SCOPE("flushFrameBuffer");
+	/* The display still shows the last flushed frame, so both its rows and ours have to be sent. */
+	int y0 = MIN(priv_dirty_y0, priv_flushed_dirty_y0);
+	int y1 = MAX(priv_dirty_y1, priv_flushed_dirty_y1);
+#ifdef CONFIG_DISPLAY_TE_SYNC
+	/* Dirty rows run across the scan direction, so only full frames can be synced to TE. */
+	bool isPartial = false;
+#else
+	bool isPartial = frameGovernor_isPartialRefreshAllowed() && (y1 >= y0) && ((y1 - y0 + 1) < DISPLAY_HEIGHT);
+#endif
+
+	if (isPartial)
+	{
+		display_drawBitmap(0, y0, DISPLAY_WIDTH, (y1 - y0) + 1, *priv_curr_frame_buffer + (y0 * DISPLAY_WIDTH));
+	}
+	else
+	{
+		display_drawScreenBuffer(*priv_curr_frame_buffer);
+	}
+
+	frameGovernor_reportFlush(isPartial);
+
+#ifdef CONFIG_CAPTURE_ENABLE
+	/* The frame buffer always holds the whole frame, also after a partial flush. */
+	frameCapture_onFlush(*priv_curr_frame_buffer, priv_world_tick);
+#endif
+
+	priv_flushed_dirty_y0 = priv_dirty_y0;
+	priv_flushed_dirty_y1 = priv_dirty_y1;
+}
+
+
+
+static void playIntro(void)
+{
+#if defined(CONFIG_VIDEO_INTRO) && defined(ENABLE_DOUBLE_BUFFERING)
+	uint8_t * const slots[2] = { (uint8_t *)priv_frame_buffer1, (uint8_t *)priv_frame_buffer2 };
+
+	videoPlayer_play(CONFIG_VIDEO_INTRO_FILE, slots, 2, FRAME_BUFFER_SIZE, &videoPlayer_displaySink, NULL);
+#endif
+}
+
+
+/***** Boot steps *****/
+
+static void boot_initPanel(void)
+{
+	/* Initialize the main display. Clear it so there is no noise on screen until the splash arrives. */
+	display_init();
+	display_fillRectangle(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, BACKGROUND_COLOR);
 }
 
+static void boot_initSdCard(void)
+{
+	sdCard_init();
+}
 
+/* The splash goes to the display band by band as it is read, instead of after the whole file. */
+static void boot_showSplash(void)
+{
+	sdCard_Read_bmp_file_progressive("/test.bmp", *priv_curr_frame_buffer, DISPLAY_WIDTH * DISPLAY_HEIGHT, SPLASH_BAND_ROWS, splashRowsReady);
+}
+
+static void splashRowsReady(int first_row, int number_of_rows)
+{
+	display_drawBitmap(0, first_row, DISPLAY_WIDTH, number_of_rows, *priv_curr_frame_buffer + (first_row * DISPLAY_WIDTH));
+	bootSeq_markFirstFrame();
+}
+
+static void boot_loadAssets(void)
+{
+	inputReplay_init();
+	srandom(inputReplay_getSeed());
+	particles_init(priv_effects_arena, inputReplay_getSeed());
+
+	loadLevelAssets();
+}
 
 /***** Helper functions *****/
+
+/* Releases the assets of the previous level and loads the current one. */
+static void loadLevelAssets(void)
+{
+	memPool_reset(priv_level_arena);
+
+	ship_buf = memPool_alloc(priv_level_arena, SHIP_BUF_WIDTH * SHIP_BUF_HEIGHT * sizeof(uint16_t));
+	assert(ship_buf);
+
+	sdCard_Read_bmp_file("/ship.bmp", ship_buf, SHIP_BUF_WIDTH * SHIP_BUF_HEIGHT);
+
+	/* Without a script the level has no waves, only the targets. */
+	(void)waves_load(priv_level_arena, CONFIG_WAVES_FILE);
+
+	for(int x = 0; x < SHIP_BUF_WIDTH * SHIP_BUF_HEIGHT; x++)
+	{
+		if (ship_buf[x] == 0xffffu)
+		{
+			ship_buf[x] = BACKGROUND_COLOR;
+		}
+	}
+}
+
+
 #define NUMBER_OF_STARS 20
 typedef struct
 {
@@ -333,6 +730,21 @@ typedef struct
 StarElement_T stars[NUMBER_OF_STARS];
 
 static void drawBackGround(void)
+{
+	TRACE_SCOPE("drawBackGround");
+	uint16_t number_of_stars = frameGovernor_getStarCount(NUMBER_OF_STARS);
+
+	drawRectangleInFrameBuf(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, BACKGROUND_COLOR);
+
+	for (int x = 0; x < number_of_stars; x++)
+	{
+		drawStar(stars[x].xPos, stars[x].yPos);
+		addDirtyRows(stars[x].yPos, 2);
+	}
+}
+
+/* Stars move with the game logic, so they stand still while paused. */
+static void updateStars(void)
 {
 	static bool isStarsInited = false;
 
@@ -340,8 +752,8 @@ static void drawBackGround(void)
 	{
 		for (int x = 0; x < NUMBER_OF_STARS; x++)
 		{
-			stars[x].xPos = random() % 320;
-			stars[x].yPos = random() % 240;
+			stars[x].xPos = random() % DISPLAY_WIDTH;
+			stars[x].yPos = random() % DISPLAY_HEIGHT;
 
 			printf("Star at : X%d, Y%d\n", stars[x].xPos, stars[x].yPos);
 		}
@@ -349,28 +761,67 @@ static void drawBackGround(void)
 		isStarsInited = true;
 	}
 
-	drawRectangleInFrameBuf(0, 0, 320, 240, BACKGROUND_COLOR);
-
 	for (int x = 0; x < NUMBER_OF_STARS; x++)
 	{
 		stars[x].xPos++;
-		if (stars[x].xPos >= 319)
+		if (stars[x].xPos >= (DISPLAY_WIDTH - 1u))
 		{
 			stars[x].xPos = 0;
 		}
+	}
+}
 
-		drawStar(stars[x].xPos, stars[x].yPos);
+
+static void getFrameState(FrameState_T * state)
+{
+	/* Cleared first, so padding can not make equal states look different. */
+	memset(state, 0, sizeof(FrameState_T));
+
+	state->yLocation = yLocation;
+	state->ship_x = ship_x;
+	state->ship_y = ship_y;
+	state->bullet_x = bullet_x;
+	state->bullet_y = bullet_y;
+	state->world_tick = priv_world_tick;
+	state->star_count = frameGovernor_getStarCount(NUMBER_OF_STARS);
+	state->particle_count = particles_getCount();
+	state->enemy_count = waves_getCount();
+	state->is_paused = priv_is_paused;
+}
+
+/* Marks rows that differ from a plain background. */
+static void addDirtyRows(int yPos, int height)
+{
+	int y1 = MIN(yPos + height - 1, (int)DISPLAY_HEIGHT - 1);
+
+	yPos = MAX(yPos, 0);
+
+	if (y1 >= yPos)
+	{
+		priv_dirty_y0 = MIN(priv_dirty_y0, yPos);
+		priv_dirty_y1 = MAX(priv_dirty_y1, y1);
 	}
 }
 
+/* The targets are the two bouncing squares. */
+static bool isBulletInTarget(int xPos, int yPos)
+{
+	int target_y = (int)DISPLAY_HEIGHT - yLocation - 40;
+
+	if ((yPos < target_y) || (yPos >= (target_y + TARGET_SIZE)))
+	{
+		return false;
+	}
+
+	return ((xPos >= TARGET_LEFT_X) && (xPos < (TARGET_LEFT_X + TARGET_SIZE))) ||
+		   ((xPos >= TARGET_RIGHT_X) && (xPos < (TARGET_RIGHT_X + TARGET_SIZE)));
+}
+
 static void drawStar(uint16_t xPos, uint16_t yPos)
 {
-	if(xPos < 319u && yPos < 239u)
+	if(xPos < (DISPLAY_WIDTH - 1u) && yPos < (DISPLAY_HEIGHT - 1u))
 	{
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos, 		yPos, 		0xffffu);
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos + 1, 	yPos,	 	0xffffu);
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos, 		yPos + 1, 	0xffffu);
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos + 1, 	yPos + 1, 	0xffffu);
+		drawRectangleInFrameBuf(xPos, yPos, 2, 2, 0xffffu);
 	}
 }
 
@@ -378,17 +829,9 @@ static void drawBullet(uint16_t xPos, uint16_t yPos)
 {
 	if (xPos < (DISPLAY_WIDTH - 1) && (yPos < (DISPLAY_HEIGHT - 1)) && (xPos > 0) &&(yPos > 0))
 	{
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos, 		yPos, 		COLOR_YELLOW);
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos + 1, 	yPos,	 	COLOR_RED);
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos, 		yPos + 1, 	COLOR_RED);
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos + 1, 	yPos + 1, 	COLOR_RED);
-
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos - 1, 	yPos,	 	COLOR_RED);
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos, 		yPos - 1, 	COLOR_RED);
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos - 1, 	yPos - 1, 	COLOR_RED);
-
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos - 1, 	yPos + 1,	COLOR_RED);
-		SET_FRAME_BUF_PIXEL(*priv_curr_frame_buffer, xPos + 1, 	yPos - 1, 	COLOR_RED);
+		/* Red 3x3 square with a yellow center. */
+		drawRectangleInFrameBuf(xPos - 1, yPos - 1, 3, 3, COLOR_RED);
+		drawRectangleInFrameBuf(xPos, yPos, 1, 1, COLOR_YELLOW);
 	}
 }
 
@@ -474,3 +917,18 @@ static void init_buttons(void)
 }
 
 
+/* Buttons are active low. */
+static uint8_t read_buttons(void)
+{
+	uint8_t res = 0u;
+
+	if (gpio_get_level(BUTTON_UP) == 0)      { res |= BUTTON_MASK_UP; }
+	if (gpio_get_level(BUTTON_DOWN) == 0)    { res |= BUTTON_MASK_DOWN; }
+	if (gpio_get_level(BUTTON_RIGHT) == 0)   { res |= BUTTON_MASK_RIGHT; }
+	if (gpio_get_level(BUTTON_LEFT) == 0)    { res |= BUTTON_MASK_LEFT; }
+	if (gpio_get_level(BUTTON_TRIGGER) == 0) { res |= BUTTON_MASK_TRIGGER; }
+
+	return res;
+}
+
+
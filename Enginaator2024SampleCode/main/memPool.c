@@ -0,0 +1,205 @@
+/*
+ * memPool.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include "memPool.h"
+
+/****************** Private defines *******************/
+
+#define MAX_NUMBER_OF_ARENAS 8u
+
+#define ALIGN_UP(x) (((x) + (MEMPOOL_ALIGNMENT - 1u)) & ~(size_t)(MEMPOOL_ALIGNMENT - 1u))
+
+/**************** Private function forward declarations **************/
+
+static uint32_t getRegionCaps(MemPoolRegion_T region);
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Memory Pool";
+
+static const char * const priv_region_names[NUMBER_OF_MEMPOOL_REGIONS] =
+{
+	"DMA",
+	"Internal",
+	"PSRAM",
+};
+
+static MemPoolArena_T priv_arenas[MAX_NUMBER_OF_ARENAS];
+static uint8_t priv_number_of_arenas = 0u;
+
+/* Arenas can be used from more than one task, for example while loading. */
+static portMUX_TYPE priv_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**************** Public functions  **************/
+
+MemPoolArena_T * memPool_createArena(const char * name, MemPoolRegion_T region, size_t size)
+{
+	MemPoolArena_T * arena;
+	uint8_t * base;
+
+	if (priv_number_of_arenas >= MAX_NUMBER_OF_ARENAS)
+	{
+		ESP_LOGE(TAG, "Too many arenas, cannot create %s", name);
+		return NULL;
+	}
+
+	size = ALIGN_UP(size);
+	base = heap_caps_aligned_alloc(MEMPOOL_ALIGNMENT, size, getRegionCaps(region));
+
+	if (base == NULL)
+	{
+		ESP_LOGE(TAG, "Failed to reserve %u bytes of %s memory for %s", (unsigned)size, priv_region_names[region], name);
+		return NULL;
+	}
+
+	arena = &priv_arenas[priv_number_of_arenas++];
+	memset(arena, 0, sizeof(MemPoolArena_T));
+
+	arena->name = name;
+	arena->region = region;
+	arena->base = base;
+	arena->capacity = size;
+
+	return arena;
+}
+
+
+void * memPool_alloc(MemPoolArena_T * arena, size_t size)
+{
+	void * res = NULL;
+
+	size = ALIGN_UP(size);
+
+	portENTER_CRITICAL(&priv_lock);
+	if ((arena->capacity - arena->used) >= size)
+	{
+		res = arena->base + arena->used;
+		arena->used += size;
+		arena->alloc_count++;
+
+		if (arena->used > arena->high_water)
+		{
+			arena->high_water = arena->used;
+		}
+	}
+	else
+	{
+		arena->failed_count++;
+	}
+	portEXIT_CRITICAL(&priv_lock);
+
+	if (res == NULL)
+	{
+		ESP_LOGE(TAG, "Arena %s over budget : %u bytes requested, %u of %u used",
+				arena->name, (unsigned)size, (unsigned)arena->used, (unsigned)arena->capacity);
+	}
+
+	return res;
+}
+
+
+void memPool_reset(MemPoolArena_T * arena)
+{
+	portENTER_CRITICAL(&priv_lock);
+	arena->used = 0u;
+	arena->alloc_count = 0u;
+	portEXIT_CRITICAL(&priv_lock);
+}
+
+
+size_t memPool_getMark(const MemPoolArena_T * arena)
+{
+	return arena->used;
+}
+
+
+void memPool_release(MemPoolArena_T * arena, size_t mark)
+{
+	portENTER_CRITICAL(&priv_lock);
+	assert(mark <= arena->used);
+	arena->used = mark;
+	portEXIT_CRITICAL(&priv_lock);
+}
+
+
+void memPool_getRegionStats(MemPoolRegion_T region, MemPoolRegionStats_T * stats)
+{
+	uint32_t caps = getRegionCaps(region);
+
+	stats->free_bytes = heap_caps_get_free_size(caps);
+	stats->largest_free_block = heap_caps_get_largest_free_block(caps);
+	stats->minimum_free_bytes = heap_caps_get_minimum_free_size(caps);
+
+	if (stats->free_bytes > 0u)
+	{
+		stats->fragmentation_pct = 100u - (uint8_t)((stats->largest_free_block * 100u) / stats->free_bytes);
+	}
+	else
+	{
+		stats->fragmentation_pct = 0u;
+	}
+}
+
+
+void memPool_printStats(void)
+{
+	MemPoolRegionStats_T stats;
+
+	for (int x = 0; x < priv_number_of_arenas; x++)
+	{
+		MemPoolArena_T * arena = &priv_arenas[x];
+
+		ESP_LOGI(TAG, "Arena %-8s (%s) : %u / %u bytes used, high water %u, %lu allocs, %lu failed",
+				arena->name,
+				priv_region_names[arena->region],
+				(unsigned)arena->used,
+				(unsigned)arena->capacity,
+				(unsigned)arena->high_water,
+				(unsigned long)arena->alloc_count,
+				(unsigned long)arena->failed_count);
+	}
+
+	for (int x = 0; x < NUMBER_OF_MEMPOOL_REGIONS; x++)
+	{
+		memPool_getRegionStats((MemPoolRegion_T)x, &stats);
+
+		ESP_LOGI(TAG, "Region %-8s : %u bytes free, largest block %u, minimum free %u, fragmentation %u%%",
+				priv_region_names[x],
+				(unsigned)stats.free_bytes,
+				(unsigned)stats.largest_free_block,
+				(unsigned)stats.minimum_free_bytes,
+				stats.fragmentation_pct);
+	}
+}
+
+/*********** Private functions ***********/
+
+static uint32_t getRegionCaps(MemPoolRegion_T region)
+{
+	switch(region)
+	{
+	case MEMPOOL_REGION_DMA:
+		return MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+	case MEMPOOL_REGION_PSRAM:
+#ifdef CONFIG_SPIRAM
+		return MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+#else
+		return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+#endif
+	case MEMPOOL_REGION_INTERNAL:
+	default:
+		return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+	}
+}
@@ -0,0 +1,68 @@
+/*
+ * memPool.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Arena allocator. Each arena takes one block from a memory region at creation and hands out
+ *  pieces of it with a simple bump pointer. Arenas are never freed piece by piece, instead the
+ *  whole arena is reset in one call (for example when a level is unloaded). This keeps the heap
+ *  from fragmenting and makes the size of each arena a hard memory budget.
+ */
+
+#ifndef MAIN_MEMPOOL_H_
+#define MAIN_MEMPOOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum
+{
+	MEMPOOL_REGION_DMA,			/* DMA capable internal RAM. Frame buffers and anything else sent to the display. */
+	MEMPOOL_REGION_INTERNAL,	/* General internal RAM. */
+	MEMPOOL_REGION_PSRAM,		/* External RAM. Falls back to internal RAM if there is no PSRAM. */
+
+	NUMBER_OF_MEMPOOL_REGIONS
+} MemPoolRegion_T;
+
+typedef struct
+{
+	const char * name;
+	MemPoolRegion_T region;
+	uint8_t * base;
+	size_t capacity;
+	size_t used;
+	size_t high_water;
+	uint32_t alloc_count;
+	uint32_t failed_count;
+} MemPoolArena_T;
+
+typedef struct
+{
+	size_t free_bytes;
+	size_t largest_free_block;
+	size_t minimum_free_bytes;	/* Lowest free_bytes since boot. */
+	uint8_t fragmentation_pct;	/* 0 when all free memory is one block. */
+} MemPoolRegionStats_T;
+
+/* Reserves size bytes from the region for a new arena. Returns NULL if the region does not have a large enough block. */
+extern MemPoolArena_T * memPool_createArena(const char * name, MemPoolRegion_T region, size_t size);
+
+/* Allocates from the arena. Returned memory is aligned to MEMPOOL_ALIGNMENT. Returns NULL if the arena budget is exceeded. */
+extern void * memPool_alloc(MemPoolArena_T * arena, size_t size);
+
+/* Releases everything allocated from the arena. The arena itself keeps its memory. */
+extern void memPool_reset(MemPoolArena_T * arena);
+
+/* Scratch memory : everything allocated after memPool_getMark is released by memPool_release with the same mark. */
+extern size_t memPool_getMark(const MemPoolArena_T * arena);
+extern void memPool_release(MemPoolArena_T * arena, size_t mark);
+
+extern void memPool_getRegionStats(MemPoolRegion_T region, MemPoolRegionStats_T * stats);
+
+/* Logs usage and high water mark of every arena, plus the state of each region. */
+extern void memPool_printStats(void);
+
+#define MEMPOOL_ALIGNMENT 16u
+
+#endif /* MAIN_MEMPOOL_H_ */
@@ -0,0 +1,129 @@
+/*
+ * panelProfile.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Compile time description of the panel selected in menuconfig. Everything that differs between
+ *  panel SKUs (controller, resolution, rotation, color order, RAM offsets and SPI clock) is turned
+ *  into constants here, so the drawing and transfer code has no run time checks for it.
+ */
+
+#ifndef MAIN_PANELPROFILE_H_
+#define MAIN_PANELPROFILE_H_
+
+#include "sdkconfig.h"
+
+/* Memory Data Access Control bits, the same on ST7789 and ILI9341 */
+#define PANEL_MADCTL_MY     0x80u
+#define PANEL_MADCTL_MX     0x40u
+#define PANEL_MADCTL_MV     0x20u
+#define PANEL_MADCTL_BGR    0x08u
+
+/***** Controllers and resolutions *****/
+
+#if defined(CONFIG_DISPLAY_PANEL_ILI9341_240X320)
+
+#define PANEL_IS_ILI9341        1
+#define PANEL_NATIVE_WIDTH      240u
+#define PANEL_NATIVE_HEIGHT     320u
+#define PANEL_SPI_CLOCK_HZ      (40 * 1000 * 1000)
+#define PANEL_COLOR_ORDER       PANEL_MADCTL_BGR
+
+#define PANEL_MADCTL_ROT_0      (PANEL_MADCTL_MX)
+#define PANEL_MADCTL_ROT_90     (PANEL_MADCTL_MV)
+#define PANEL_MADCTL_ROT_180    (PANEL_MADCTL_MY)
+#define PANEL_MADCTL_ROT_270    (PANEL_MADCTL_MX | PANEL_MADCTL_MY | PANEL_MADCTL_MV)
+
+#define PANEL_X_OFFSET_ROT_0    0u
+#define PANEL_Y_OFFSET_ROT_0    0u
+#define PANEL_X_OFFSET_ROT_90   0u
+#define PANEL_Y_OFFSET_ROT_90   0u
+#define PANEL_X_OFFSET_ROT_180  0u
+#define PANEL_Y_OFFSET_ROT_180  0u
+#define PANEL_X_OFFSET_ROT_270  0u
+#define PANEL_Y_OFFSET_ROT_270  0u
+
+#elif defined(CONFIG_DISPLAY_PANEL_ST7789_240X240)
+
+/* 240 x 240 glass on a 240 x 320 controller. When the rows are mirrored, the visible part starts 80 rows in. */
+#define PANEL_IS_ST7789         1
+#define PANEL_NATIVE_WIDTH      240u
+#define PANEL_NATIVE_HEIGHT     240u
+#define PANEL_SPI_CLOCK_HZ      (40 * 1000 * 1000)
+#define PANEL_COLOR_ORDER       0u
+
+#define PANEL_MADCTL_ROT_0      0u
+#define PANEL_MADCTL_ROT_90     (PANEL_MADCTL_MX | PANEL_MADCTL_MV)
+#define PANEL_MADCTL_ROT_180    (PANEL_MADCTL_MX | PANEL_MADCTL_MY)
+#define PANEL_MADCTL_ROT_270    (PANEL_MADCTL_MY | PANEL_MADCTL_MV)
+
+#define PANEL_X_OFFSET_ROT_0    0u
+#define PANEL_Y_OFFSET_ROT_0    0u
+#define PANEL_X_OFFSET_ROT_90   0u
+#define PANEL_Y_OFFSET_ROT_90   0u
+#define PANEL_X_OFFSET_ROT_180  0u
+#define PANEL_Y_OFFSET_ROT_180  80u
+#define PANEL_X_OFFSET_ROT_270  80u
+#define PANEL_Y_OFFSET_ROT_270  0u
+
+#else /* CONFIG_DISPLAY_PANEL_ST7789_240X320, the original board */
+
+#define PANEL_IS_ST7789         1
+#define PANEL_NATIVE_WIDTH      240u
+#define PANEL_NATIVE_HEIGHT     320u
+#define PANEL_SPI_CLOCK_HZ      (40 * 1000 * 1000)
+#define PANEL_COLOR_ORDER       0u      /* BGR is handled by the XOR bit of LCM Control */
+
+#define PANEL_MADCTL_ROT_0      0u
+#define PANEL_MADCTL_ROT_90     (PANEL_MADCTL_MX | PANEL_MADCTL_MV)
+#define PANEL_MADCTL_ROT_180    (PANEL_MADCTL_MX | PANEL_MADCTL_MY)
+#define PANEL_MADCTL_ROT_270    (PANEL_MADCTL_MY | PANEL_MADCTL_MV)
+
+#define PANEL_X_OFFSET_ROT_0    0u
+#define PANEL_Y_OFFSET_ROT_0    0u
+#define PANEL_X_OFFSET_ROT_90   0u
+#define PANEL_Y_OFFSET_ROT_90   0u
+#define PANEL_X_OFFSET_ROT_180  0u
+#define PANEL_Y_OFFSET_ROT_180  0u
+#define PANEL_X_OFFSET_ROT_270  0u
+#define PANEL_Y_OFFSET_ROT_270  0u
+
+#endif
+
+/***** Rotation *****/
+
+#if defined(CONFIG_DISPLAY_ROTATION_0)
+#define PANEL_MADCTL            (PANEL_MADCTL_ROT_0 | PANEL_COLOR_ORDER)
+#define PANEL_X_OFFSET          PANEL_X_OFFSET_ROT_0
+#define PANEL_Y_OFFSET          PANEL_Y_OFFSET_ROT_0
+#define PANEL_IS_LANDSCAPE      0
+#elif defined(CONFIG_DISPLAY_ROTATION_180)
+#define PANEL_MADCTL            (PANEL_MADCTL_ROT_180 | PANEL_COLOR_ORDER)
+#define PANEL_X_OFFSET          PANEL_X_OFFSET_ROT_180
+#define PANEL_Y_OFFSET          PANEL_Y_OFFSET_ROT_180
+#define PANEL_IS_LANDSCAPE      0
+#elif defined(CONFIG_DISPLAY_ROTATION_270)
+#define PANEL_MADCTL            (PANEL_MADCTL_ROT_270 | PANEL_COLOR_ORDER)
+#define PANEL_X_OFFSET          PANEL_X_OFFSET_ROT_270
+#define PANEL_Y_OFFSET          PANEL_Y_OFFSET_ROT_270
+#define PANEL_IS_LANDSCAPE      1
+#else /* CONFIG_DISPLAY_ROTATION_90, the default landscape mode */
+#define PANEL_MADCTL            (PANEL_MADCTL_ROT_90 | PANEL_COLOR_ORDER)
+#define PANEL_X_OFFSET          PANEL_X_OFFSET_ROT_90
+#define PANEL_Y_OFFSET          PANEL_Y_OFFSET_ROT_90
+#define PANEL_IS_LANDSCAPE      1
+#endif
+
+/* With the row/column exchange (MV) the controller scans along the x axis of the screen. */
+#define PANEL_SCAN_ALONG_X      PANEL_IS_LANDSCAPE
+
+#if PANEL_IS_LANDSCAPE
+#define PANEL_WIDTH             PANEL_NATIVE_HEIGHT
+#define PANEL_HEIGHT            PANEL_NATIVE_WIDTH
+#else
+#define PANEL_WIDTH             PANEL_NATIVE_WIDTH
+#define PANEL_HEIGHT            PANEL_NATIVE_HEIGHT
+#endif
+
+#endif /* MAIN_PANELPROFILE_H_ */
@@ -0,0 +1,321 @@
+/*
+ * particles.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "sdkconfig.h"
+#include "esp_log.h"
+
+#include "particles.h"
+#include "display.h"
+
+/****************** Private defines *******************/
+
+#define PARTICLE_POOL_SIZE CONFIG_PARTICLE_POOL_SIZE
+
+#define NUMBER_OF_DIRECTIONS 32u
+#define RAMP_LENGTH 8u
+
+#define FP_ONE (1 << PARTICLE_FP_SHIFT)
+#define TO_FP(x) ((int16_t)((x) * FP_ONE))
+
+/****************** Private type definitions *******************/
+
+typedef struct
+{
+	uint16_t ramp[RAMP_LENGTH];		/* Index 0 is used at the end of the lifetime. */
+	int16_t gravity;				/* Added to vy every frame. */
+	uint8_t min_life;
+	uint8_t life_range;
+} ParticleKindDef_T;
+
+/**************** Private function forward declarations **************/
+
+static inline uint32_t nextRandom(void);
+static void emit(ParticleKind_T kind, int16_t xPos, int16_t yPos, int16_t vx, int16_t vy);
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Particles";
+
+/* Unit vectors in 1/64 units, evenly spread around the circle. */
+static const int8_t priv_directions[NUMBER_OF_DIRECTIONS][2] =
+{
+	{  64,    0}, {  63,   12}, {  59,   24}, {  53,   36},
+	{  45,   45}, {  36,   53}, {  24,   59}, {  12,   63},
+	{   0,   64}, { -12,   63}, { -24,   59}, { -36,   53},
+	{ -45,   45}, { -53,   36}, { -59,   24}, { -63,   12},
+	{ -64,    0}, { -63,  -12}, { -59,  -24}, { -53,  -36},
+	{ -45,  -45}, { -36,  -53}, { -24,  -59}, { -12,  -63},
+	{   0,  -64}, {  12,  -63}, {  24,  -59}, {  36,  -53},
+	{  45,  -45}, {  53,  -36}, {  59,  -24}, {  63,  -12},
+};
+
+static const ParticleKindDef_T priv_kinds[NUMBER_OF_PARTICLE_KINDS] =
+{
+	[PARTICLE_KIND_EXPLOSION] =
+	{
+		.ramp =
+		{
+			CONVERT_888RGB_TO_565RGB(40,  0,   0  ),
+			CONVERT_888RGB_TO_565RGB(100, 10,  0  ),
+			CONVERT_888RGB_TO_565RGB(170, 30,  0  ),
+			CONVERT_888RGB_TO_565RGB(230, 70,  0  ),
+			CONVERT_888RGB_TO_565RGB(255, 130, 0  ),
+			CONVERT_888RGB_TO_565RGB(255, 200, 40 ),
+			CONVERT_888RGB_TO_565RGB(255, 240, 150),
+			CONVERT_888RGB_TO_565RGB(255, 255, 255),
+		},
+		.gravity = 1,
+		.min_life = 20u,
+		.life_range = 24u,
+	},
+	[PARTICLE_KIND_THRUST] =
+	{
+		.ramp =
+		{
+			CONVERT_888RGB_TO_565RGB(0,   0,   40 ),
+			CONVERT_888RGB_TO_565RGB(0,   20,  100),
+			CONVERT_888RGB_TO_565RGB(0,   60,  170),
+			CONVERT_888RGB_TO_565RGB(0,   120, 230),
+			CONVERT_888RGB_TO_565RGB(40,  180, 255),
+			CONVERT_888RGB_TO_565RGB(120, 230, 255),
+			CONVERT_888RGB_TO_565RGB(200, 250, 255),
+			CONVERT_888RGB_TO_565RGB(255, 255, 255),
+		},
+		.gravity = 0,
+		.min_life = 6u,
+		.life_range = 8u,
+	},
+};
+
+/* The pool, as separate arrays so the update loop streams through memory. */
+static int16_t * priv_x;
+static int16_t * priv_y;
+static int16_t * priv_vx;
+static int16_t * priv_vy;
+static uint8_t * priv_life;
+static uint8_t * priv_max_life;
+static uint8_t * priv_kind;
+
+/* Particle indexes sorted by row. Particles of row y are priv_order[priv_row_start[y]] ... priv_order[priv_row_start[y + 1] - 1] */
+static uint16_t * priv_order;
+static uint16_t priv_row_start[DISPLAY_HEIGHT + 1];
+static uint16_t priv_row_fill[DISPLAY_HEIGHT];
+
+static uint16_t priv_count = 0u;
+static uint16_t priv_budget = PARTICLE_POOL_SIZE;
+static uint32_t priv_random_state = 1u;
+static ParticleBounds_T priv_bounds;
+
+/**************** Public functions  **************/
+
+void particles_init(MemPoolArena_T * arena, uint32_t seed)
+{
+	priv_x 			= memPool_alloc(arena, PARTICLE_POOL_SIZE * sizeof(int16_t));
+	priv_y 			= memPool_alloc(arena, PARTICLE_POOL_SIZE * sizeof(int16_t));
+	priv_vx 		= memPool_alloc(arena, PARTICLE_POOL_SIZE * sizeof(int16_t));
+	priv_vy 		= memPool_alloc(arena, PARTICLE_POOL_SIZE * sizeof(int16_t));
+	priv_life 		= memPool_alloc(arena, PARTICLE_POOL_SIZE * sizeof(uint8_t));
+	priv_max_life 	= memPool_alloc(arena, PARTICLE_POOL_SIZE * sizeof(uint8_t));
+	priv_kind 		= memPool_alloc(arena, PARTICLE_POOL_SIZE * sizeof(uint8_t));
+	priv_order 		= memPool_alloc(arena, PARTICLE_POOL_SIZE * sizeof(uint16_t));
+
+	assert(priv_x && priv_y && priv_vx && priv_vy && priv_life && priv_max_life && priv_kind && priv_order);
+
+	/* xorshift does not work with a zero state. */
+	priv_random_state = (seed != 0u) ? seed : 1u;
+	priv_count = 0u;
+	memset(priv_row_start, 0, sizeof(priv_row_start));
+	memset(&priv_bounds, 0, sizeof(priv_bounds));
+
+	ESP_LOGI(TAG, "Particle pool of %d reserved", PARTICLE_POOL_SIZE);
+}
+
+
+void particles_setBudget(uint16_t budget)
+{
+	priv_budget = MIN(budget, PARTICLE_POOL_SIZE);
+}
+
+
+void particles_emitExplosion(int xPos, int yPos, uint16_t count)
+{
+	uint32_t rnd;
+	int16_t speed;
+	const int8_t * dir;
+
+	for (int x = 0; x < count; x++)
+	{
+		rnd = nextRandom();
+		dir = priv_directions[rnd % NUMBER_OF_DIRECTIONS];
+
+		/* Between 1/4 and 2.5 pixels per frame. */
+		speed = 16 + (int16_t)((rnd >> 8) % 144u);
+
+		emit(PARTICLE_KIND_EXPLOSION, TO_FP(xPos), TO_FP(yPos), (dir[0] * speed) / FP_ONE, (dir[1] * speed) / FP_ONE);
+	}
+}
+
+
+void particles_emitThrust(int xPos, int yPos, uint16_t count)
+{
+	uint32_t rnd;
+
+	for (int x = 0; x < count; x++)
+	{
+		rnd = nextRandom();
+
+		/* Exhaust goes towards +x, the ship flies towards -x. */
+		emit(PARTICLE_KIND_THRUST, TO_FP(xPos), TO_FP(yPos) + (int16_t)((rnd >> 16) % (4 * FP_ONE)) - (2 * FP_ONE),
+				FP_ONE + (int16_t)(rnd % (2u * FP_ONE)),
+				(int16_t)((rnd >> 8) % 33u) - 16);
+	}
+}
+
+
+void particles_update(void)
+{
+	const int16_t max_x = TO_FP(DISPLAY_WIDTH);
+	const int16_t max_y = TO_FP(DISPLAY_HEIGHT);
+	uint16_t ix = 0u;
+	int16_t px, py;
+
+	memset(priv_row_fill, 0, sizeof(priv_row_fill));
+	priv_bounds.is_valid = false;
+	priv_bounds.x0 = DISPLAY_WIDTH;
+	priv_bounds.y0 = DISPLAY_HEIGHT;
+	priv_bounds.x1 = -1;
+	priv_bounds.y1 = -1;
+
+	/* Move and expire. Dead particles are replaced by the last one, so the live ones stay packed at the start. */
+	while (ix < priv_count)
+	{
+		priv_life[ix]--;
+		priv_vy[ix] += priv_kinds[priv_kind[ix]].gravity;
+		priv_x[ix] += priv_vx[ix];
+		priv_y[ix] += priv_vy[ix];
+
+		if ((priv_life[ix] == 0u) || (priv_x[ix] < 0) || (priv_x[ix] >= max_x) || (priv_y[ix] < 0) || (priv_y[ix] >= max_y))
+		{
+			priv_count--;
+			priv_x[ix] = priv_x[priv_count];
+			priv_y[ix] = priv_y[priv_count];
+			priv_vx[ix] = priv_vx[priv_count];
+			priv_vy[ix] = priv_vy[priv_count];
+			priv_life[ix] = priv_life[priv_count];
+			priv_max_life[ix] = priv_max_life[priv_count];
+			priv_kind[ix] = priv_kind[priv_count];
+			continue;
+		}
+
+		px = priv_x[ix] >> PARTICLE_FP_SHIFT;
+		py = priv_y[ix] >> PARTICLE_FP_SHIFT;
+
+		priv_row_fill[py]++;
+		priv_bounds.x0 = MIN(priv_bounds.x0, px);
+		priv_bounds.x1 = MAX(priv_bounds.x1, px);
+		priv_bounds.y0 = MIN(priv_bounds.y0, py);
+		priv_bounds.y1 = MAX(priv_bounds.y1, py);
+		ix++;
+	}
+
+	priv_bounds.is_valid = (priv_count > 0u);
+
+	/* Counting sort by row. */
+	priv_row_start[0] = 0u;
+	for (int y = 0; y < DISPLAY_HEIGHT; y++)
+	{
+		priv_row_start[y + 1] = priv_row_start[y] + priv_row_fill[y];
+		priv_row_fill[y] = priv_row_start[y];
+	}
+
+	for (ix = 0u; ix < priv_count; ix++)
+	{
+		py = priv_y[ix] >> PARTICLE_FP_SHIFT;
+		priv_order[priv_row_fill[py]++] = ix;
+	}
+}
+
+
+void particles_renderRows(uint16_t * frame_buf, int first_row, int end_row)
+{
+	uint16_t ix;
+	uint16_t * row_ptr;
+	const ParticleKindDef_T * kind;
+
+	if (!priv_bounds.is_valid)
+	{
+		return;
+	}
+
+	first_row = MAX(first_row, priv_bounds.y0);
+	end_row = MIN(end_row, priv_bounds.y1 + 1);
+
+	for (int y = first_row; y < end_row; y++)
+	{
+		row_ptr = frame_buf + (y * DISPLAY_WIDTH);
+
+		for (int n = priv_row_start[y]; n < priv_row_start[y + 1]; n++)
+		{
+			ix = priv_order[n];
+			kind = &priv_kinds[priv_kind[ix]];
+
+			row_ptr[priv_x[ix] >> PARTICLE_FP_SHIFT] = kind->ramp[(priv_life[ix] * RAMP_LENGTH) / (priv_max_life[ix] + 1u)];
+		}
+	}
+}
+
+
+void particles_getBounds(ParticleBounds_T * bounds)
+{
+	*bounds = priv_bounds;
+}
+
+
+uint16_t particles_getCount(void)
+{
+	return priv_count;
+}
+
+/*********** Private functions ***********/
+
+/* xorshift32 */
+static inline uint32_t nextRandom(void)
+{
+	uint32_t x = priv_random_state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	priv_random_state = x;
+
+	return x;
+}
+
+
+static void emit(ParticleKind_T kind, int16_t xPos, int16_t yPos, int16_t vx, int16_t vy)
+{
+	const ParticleKindDef_T * def = &priv_kinds[kind];
+	uint16_t ix;
+
+	if (priv_count >= priv_budget)
+	{
+		return;
+	}
+
+	ix = priv_count++;
+
+	priv_x[ix] = xPos;
+	priv_y[ix] = yPos;
+	priv_vx[ix] = vx;
+	priv_vy[ix] = vy;
+	priv_kind[ix] = kind;
+	priv_max_life[ix] = def->min_life + (uint8_t)(nextRandom() % def->life_range);
+	priv_life[ix] = priv_max_life[ix];
+}
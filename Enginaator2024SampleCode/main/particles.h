@@ -0,0 +1,59 @@
+/*
+ * particles.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Pooled particle system for explosions and thrusters. Particles are kept in a fixed size
+ *  structure of arrays pool with fixed point positions. The update step also sorts the live
+ *  particles by row, so rendering writes the frame buffer from top to bottom.
+ */
+
+#ifndef MAIN_PARTICLES_H_
+#define MAIN_PARTICLES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "memPool.h"
+
+/* Positions and velocities are in 1/64 pixel units. */
+#define PARTICLE_FP_SHIFT 6
+
+typedef enum
+{
+	PARTICLE_KIND_EXPLOSION,
+	PARTICLE_KIND_THRUST,
+
+	NUMBER_OF_PARTICLE_KINDS
+} ParticleKind_T;
+
+/* Area of the screen touched by the particles in the last update. Can be used for partial display updates. */
+typedef struct
+{
+	bool is_valid;
+	int16_t x0;
+	int16_t y0;
+	int16_t x1;		/* Inclusive */
+	int16_t y1;		/* Inclusive */
+} ParticleBounds_T;
+
+/* Reserves the pool from the arena. The seed makes the effects repeatable together with the input replay. */
+extern void particles_init(MemPoolArena_T * arena, uint32_t seed);
+
+/* Limits the number of live particles. New particles over the budget are not emitted. */
+extern void particles_setBudget(uint16_t budget);
+
+extern void particles_emitExplosion(int xPos, int yPos, uint16_t count);
+extern void particles_emitThrust(int xPos, int yPos, uint16_t count);
+
+/* Moves all particles one frame forward, removes the expired ones and sorts the rest by row. */
+extern void particles_update(void);
+
+/* Draws the live particles on rows first_row ... end_row - 1 into a DISPLAY_WIDTH x DISPLAY_HEIGHT frame buffer. */
+extern void particles_renderRows(uint16_t * frame_buf, int first_row, int end_row);
+
+extern void particles_getBounds(ParticleBounds_T * bounds);
+extern uint16_t particles_getCount(void);
+
+#endif /* MAIN_PARTICLES_H_ */
@@ -0,0 +1,301 @@
+/*
+ * renderBands.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "renderBands.h"
+#include "display.h"
+#include "trace.h"
+
+/****************** Private defines *******************/
+
+#define RENDER_MAX_COMMANDS 	128u
+#define BAND_HEIGHT 			((DISPLAY_HEIGHT + RENDER_NUMBER_OF_BANDS - 1u) / RENDER_NUMBER_OF_BANDS)
+
+#define RENDER_TASK_STACK_SIZE 	3072u
+/* Same priority as the game loop task, so it only competes with it on its own core, and above the capture writer. */
+#define RENDER_TASK_PRIORITY 	2u
+
+/****************** Private type definitions *******************/
+
+typedef enum
+{
+	RENDER_CMD_FILL_RECT,
+	RENDER_CMD_BLIT_COLUMNS,
+	RENDER_CMD_CALLBACK,
+} RenderCommandType_T;
+
+typedef struct
+{
+	RenderCommandType_T type;
+	int16_t xPos;
+	int16_t yPos;
+	int16_t width;
+	int16_t height;
+	uint16_t color;
+	const uint16_t * data;
+	RenderBandsCallback_T callback;
+} RenderCommand_T;
+
+/**************** Private function forward declarations **************/
+
+static RenderCommand_T * addCommand(RenderCommandType_T type, int xPos, int yPos, int width, int height);
+static void renderBand(int band);
+#ifdef CONFIG_RENDER_PARALLEL
+static void renderWorkerTask(void * param);
+#endif
+
+static void fillRect(uint16_t * frame_buf, const RenderCommand_T * cmd, int first_row, int end_row);
+static void blitColumns(uint16_t * frame_buf, const RenderCommand_T * cmd, int first_row, int end_row);
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Render Bands";
+
+static RenderCommand_T priv_commands[RENDER_MAX_COMMANDS];
+static uint16_t priv_number_of_commands = 0u;
+
+/* Indexes of the commands that touch each band, in submission order. */
+static uint8_t priv_bins[RENDER_NUMBER_OF_BANDS][RENDER_MAX_COMMANDS];
+static uint16_t priv_bin_count[RENDER_NUMBER_OF_BANDS];
+
+static uint16_t * priv_frame_buf;
+static bool priv_isOverflowReported = false;
+
+#ifdef CONFIG_RENDER_PARALLEL
+/* Band 0 is rendered by the caller of renderBands_execute, the others by these tasks. */
+static TaskHandle_t priv_workers[RENDER_NUMBER_OF_BANDS];
+static SemaphoreHandle_t priv_bands_done;
+#endif
+
+/**************** Public functions  **************/
+
+void renderBands_init(void)
+{
+#ifdef CONFIG_RENDER_PARALLEL
+	priv_bands_done = xSemaphoreCreateCounting(RENDER_NUMBER_OF_BANDS, 0u);
+	assert(priv_bands_done);
+
+	for (uintptr_t band = 1u; band < RENDER_NUMBER_OF_BANDS; band++)
+	{
+		BaseType_t res;
+#if portNUM_PROCESSORS > 1
+		res = xTaskCreatePinnedToCore(renderWorkerTask, "render", RENDER_TASK_STACK_SIZE, (void *)band, RENDER_TASK_PRIORITY, &priv_workers[band], band % portNUM_PROCESSORS);
+#else
+		res = xTaskCreate(renderWorkerTask, "render", RENDER_TASK_STACK_SIZE, (void *)band, RENDER_TASK_PRIORITY, &priv_workers[band]);
+#endif
+		assert(res == pdPASS);
+		(void)res;
+	}
+#endif
+}
+
+
+void renderBands_begin(uint16_t * frame_buf)
+{
+	priv_frame_buf = frame_buf;
+	priv_number_of_commands = 0u;
+	memset(priv_bin_count, 0, sizeof(priv_bin_count));
+}
+
+
+void renderBands_fillRect(int xPos, int yPos, int width, int height, uint16_t color)
+{
+	RenderCommand_T * cmd = addCommand(RENDER_CMD_FILL_RECT, xPos, yPos, width, height);
+
+	if (cmd != NULL)
+	{
+		cmd->color = color;
+	}
+}
+
+
+void renderBands_blitColumns(int xPos, int yPos, int width, int height, const uint16_t * data)
+{
+	RenderCommand_T * cmd = addCommand(RENDER_CMD_BLIT_COLUMNS, xPos, yPos, width, height);
+
+	if (cmd != NULL)
+	{
+		cmd->data = data;
+	}
+}
+
+
+void renderBands_callback(int yPos, int height, RenderBandsCallback_T callback)
+{
+	RenderCommand_T * cmd = addCommand(RENDER_CMD_CALLBACK, 0, yPos, DISPLAY_WIDTH, height);
+
+	if (cmd != NULL)
+	{
+		cmd->callback = callback;
+	}
+}
+
+
+void renderBands_execute(void)
+{
+#ifdef CONFIG_RENDER_PARALLEL
+	for (int band = 1; band < RENDER_NUMBER_OF_BANDS; band++)
+	{
+		xTaskNotifyGive(priv_workers[band]);
+	}
+
+	renderBand(0);
+
+	/* Barrier, the frame can not be flushed before every band is done. */
+	for (int band = 1; band < RENDER_NUMBER_OF_BANDS; band++)
+	{
+		xSemaphoreTake(priv_bands_done, portMAX_DELAY);
+	}
+#else
+	for (int band = 0; band < RENDER_NUMBER_OF_BANDS; band++)
+	{
+		renderBand(band);
+	}
+#endif
+}
+
+/*********** Private functions ***********/
+
+/* Records a command and puts it into the bin of every band it overlaps. Returns NULL if it is completely off screen. */
+static RenderCommand_T * addCommand(RenderCommandType_T type, int xPos, int yPos, int width, int height)
+{
+	RenderCommand_T * cmd;
+	int first_band, last_band;
+
+	if ((width <= 0) || (height <= 0) || (xPos >= (int)DISPLAY_WIDTH) || (yPos >= (int)DISPLAY_HEIGHT) || ((xPos + width) <= 0) || ((yPos + height) <= 0))
+	{
+		return NULL;
+	}
+
+	if (priv_number_of_commands >= RENDER_MAX_COMMANDS)
+	{
+		if (!priv_isOverflowReported)
+		{
+			ESP_LOGE(TAG, "More than %d draw commands in a frame, rest are dropped", RENDER_MAX_COMMANDS);
+			priv_isOverflowReported = true;
+		}
+		return NULL;
+	}
+
+	cmd = &priv_commands[priv_number_of_commands];
+	cmd->type = type;
+	cmd->xPos = xPos;
+	cmd->yPos = yPos;
+	cmd->width = width;
+	cmd->height = height;
+
+	first_band = MAX(yPos, 0) / BAND_HEIGHT;
+	last_band = MIN(yPos + height - 1, (int)DISPLAY_HEIGHT - 1) / BAND_HEIGHT;
+
+	for (int band = first_band; band <= last_band; band++)
+	{
+		priv_bins[band][priv_bin_count[band]++] = priv_number_of_commands;
+	}
+
+	priv_number_of_commands++;
+
+	return cmd;
+}
+
+
+static void renderBand(int band)
+{
+	TRACE_SCOPE("render_band");
+	int first_row = band * BAND_HEIGHT;
+	int end_row = MIN(first_row + BAND_HEIGHT, DISPLAY_HEIGHT);
+	const RenderCommand_T * cmd;
+	int cmd_first_row, cmd_end_row;
+
+	for (int x = 0; x < priv_bin_count[band]; x++)
+	{
+		cmd = &priv_commands[priv_bins[band][x]];
+
+		/* Clip to the band. */
+		cmd_first_row = MAX(first_row, cmd->yPos);
+		cmd_end_row = MIN(end_row, cmd->yPos + cmd->height);
+
+		switch(cmd->type)
+		{
+		case RENDER_CMD_FILL_RECT:
+			fillRect(priv_frame_buf, cmd, cmd_first_row, cmd_end_row);
+			break;
+		case RENDER_CMD_BLIT_COLUMNS:
+			blitColumns(priv_frame_buf, cmd, cmd_first_row, cmd_end_row);
+			break;
+		case RENDER_CMD_CALLBACK:
+			cmd->callback(priv_frame_buf, cmd_first_row, cmd_end_row);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+
+#ifdef CONFIG_RENDER_PARALLEL
+static void renderWorkerTask(void * param)
+{
+	int band = (int)(uintptr_t)param;
+
+	ESP_LOGI(TAG, "Render worker for band %d started", band);
+
+	while(1)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		renderBand(band);
+		xSemaphoreGive(priv_bands_done);
+	}
+}
+#endif
+
+
+/* Rows are written one after the other, so the frame buffer is accessed sequentially. */
+static void fillRect(uint16_t * frame_buf, const RenderCommand_T * cmd, int first_row, int end_row)
+{
+	int x0 = MAX(cmd->xPos, 0);
+	int x1 = MIN(cmd->xPos + cmd->width, (int)DISPLAY_WIDTH);
+	uint16_t * row_ptr;
+
+	for (int y = first_row; y < end_row; y++)
+	{
+		row_ptr = frame_buf + (y * DISPLAY_WIDTH);
+
+		for (int x = x0; x < x1; x++)
+		{
+			row_ptr[x] = cmd->color;
+		}
+	}
+}
+
+
+static void blitColumns(uint16_t * frame_buf, const RenderCommand_T * cmd, int first_row, int end_row)
+{
+	int x0 = MAX(cmd->xPos, 0);
+	int x1 = MIN(cmd->xPos + cmd->width, (int)DISPLAY_WIDTH);
+	const uint16_t * src_ptr;
+	uint16_t * row_ptr;
+
+	for (int y = first_row; y < end_row; y++)
+	{
+		row_ptr = frame_buf + (y * DISPLAY_WIDTH);
+		src_ptr = cmd->data + ((x0 - cmd->xPos) * cmd->height) + (y - cmd->yPos);
+
+		for (int x = x0; x < x1; x++)
+		{
+			row_ptr[x] = *src_ptr;
+			src_ptr += cmd->height;
+		}
+	}
+}
@@ -0,0 +1,40 @@
+/*
+ * renderBands.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Banded frame buffer rasterization. Draw calls during a frame only record commands, which are
+ *  binned by the horizontal bands of the screen they touch. renderBands_execute then renders every
+ *  band in parallel, one worker per core, and returns when all bands are finished (so the frame
+ *  can be flushed). Commands are executed in the order they were submitted.
+ */
+
+#ifndef MAIN_RENDERBANDS_H_
+#define MAIN_RENDERBANDS_H_
+
+#include <stdint.h>
+
+#define RENDER_NUMBER_OF_BANDS 2u
+
+/* Draws the rows first_row ... end_row - 1 of a custom element. */
+typedef void (*RenderBandsCallback_T)(uint16_t * frame_buf, int first_row, int end_row);
+
+/* Starts the worker tasks. */
+extern void renderBands_init(void);
+
+/* Starts recording a new frame into frame_buf. */
+extern void renderBands_begin(uint16_t * frame_buf);
+
+extern void renderBands_fillRect(int xPos, int yPos, int width, int height, uint16_t color);
+
+/* Sprite stored column by column : pixel (x, y) of the sprite is data[(x * height) + y]. */
+extern void renderBands_blitColumns(int xPos, int yPos, int width, int height, const uint16_t * data);
+
+/* Custom element covering rows yPos ... yPos + height - 1. */
+extern void renderBands_callback(int yPos, int height, RenderBandsCallback_T callback);
+
+/* Renders all recorded commands. Returns when the whole frame buffer is done. */
+extern void renderBands_execute(void);
+
+#endif /* MAIN_RENDERBANDS_H_ */
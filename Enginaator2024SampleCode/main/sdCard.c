@@ -10,53 +10,55 @@
 #include "esp_timer.h"
 #include "esp_task_wdt.h"
 #include "esp_vfs_fat.h"
+#include "freertos/semphr.h"
 
 #include "sdCard.h"
 #include "display.h"
+#include "bmpStream.h"
+#include "assetPack.h"
+#include "trace.h"
 
 #define MOUNT_POINT "/sdcard"
 #define PIN_NUM_CS    7
 
+#define ASSET_PACK_PATH MOUNT_POINT"/assets.pak"
+
 
 /****************** Private type definitions *******************/
 
-#pragma pack(push)  // save the original data alignment
-#pragma pack(1)     // Set data alignment to 1 byte boundary
+/* A bitmap is read either from its own file or from an entry of the asset pack. */
 typedef struct
 {
-    uint16_t type;              // Magic identifier: 0x4d42
-    uint32_t size;              // File size in bytes
-    uint16_t reserved1;         // Not used
-    uint16_t reserved2;         // Not used
-    uint32_t offset;            // Offset to image data in bytes from beginning of file
-    uint32_t dib_header_size;   // DIB Header size in bytes
-    int32_t  width_px;          // Width of the image
-    int32_t  height_px;         // Height of image
-    uint16_t num_planes;        // Number of color planes
-    uint16_t bits_per_pixel;    // Bits per pixel
-    uint32_t compression;       // Compression type
-    uint32_t image_size_bytes;  // Image size in bytes
-    int32_t  x_resolution_ppm;  // Pixels per meter
-    int32_t  y_resolution_ppm;  // Pixels per meter
-    uint32_t num_colors;        // Number of colors
-    uint32_t important_colors;  // Important colors
-} BMPHeader;
-#pragma pack(pop)  // restore the previous pack setting
+    FILE * f;
+    const AssetPackEntry_T * entry;
+    sdCard_RowsReadyCallback_T callback;
+} BmpSource_T;
 
 
 /**************** Private function forward declarations **************/
-static esp_err_t read_bmp_file(const char *path, uint16_t * output_buffer);
+static esp_err_t read_bmp_file(const BmpSource_T * src, uint16_t * output_buffer, uint32_t output_pixels, int band_rows, sdCard_RowsReadyCallback_T callback);
+static esp_err_t read_rgb565_asset(const AssetPackEntry_T * entry, uint16_t * output_buffer, uint32_t output_pixels, int band_rows, sdCard_RowsReadyCallback_T callback);
+static esp_err_t source_read(const BmpSource_T * src, uint32_t offset, void * buf, uint32_t len);
+static int bmp_read_callback(void * ctx, uint32_t offset, void * buf, uint32_t len);
+static void bmp_band_callback(void * ctx, int first_row, int number_of_rows, int width, uint16_t * pixels);
 static const char *TAG = "SD Card Handler";
 
 /**************** Private variable declarations ******************/
 
-uint8_t  bmp_line_buffer[(MAX_BMP_LINE_LENGTH * 3) + 4u];
+/* Word aligned, so the line converters can take their fast path. Large enough for a 32bpp line. */
+uint32_t bmp_line_buffer[MAX_BMP_LINE_LENGTH];
+
+/* Files can be loaded from more than one task during boot, the line buffer is shared. */
+static SemaphoreHandle_t priv_read_lock;
 
 /**************** Public functions  **************/
 void sdCard_init(void)
 {
 	esp_err_t ret;
 
+	priv_read_lock = xSemaphoreCreateMutex();
+	assert(priv_read_lock);
+
 	// Options for mounting the filesystem.
     esp_vfs_fat_sdmmc_mount_config_t mount_config =
     {
@@ -104,6 +106,9 @@ void sdCard_init(void)
 
     ESP_LOGI(TAG, "Filesystem mounted");
 
+    /* If there is a pack, assets are served from it and single files are only used for what it does not contain. */
+    assetPack_open(ASSET_PACK_PATH);
+
 #if 0
     /* Lets try to load a bitmap. */
     const char *file_logo = MOUNT_POINT"/test.bmp";
@@ -123,55 +128,169 @@ void sdCard_init(void)
 }
 
 
-void sdCard_Read_bmp_file(const char *path, uint16_t * output_buffer)
+esp_err_t sdCard_Read_bmp_file(const char *path, uint16_t * output_buffer, uint32_t output_pixels)
 {
-	char str[64] = MOUNT_POINT;
-	strcat(str, path);
+	return sdCard_Read_bmp_file_progressive(path, output_buffer, output_pixels, 0, NULL);
+}
 
-	read_bmp_file(str, output_buffer);
+
+esp_err_t sdCard_Read_bmp_file_progressive(const char *path, uint16_t * output_buffer, uint32_t output_pixels, int band_rows, sdCard_RowsReadyCallback_T callback)
+{
+	TRACE_SCOPE("sdCard_Read_bmp_file");
+	BmpSource_T src = { NULL, NULL, NULL };
+	char str[64] = MOUNT_POINT;
+	esp_err_t res = ESP_FAIL;
+
+	if (assetPack_isOpen())
+	{
+		src.entry = assetPack_find(path);
+	}
+
+	xSemaphoreTake(priv_read_lock, portMAX_DELAY);
+
+	if ((src.entry != NULL) && (src.entry->format == ASSET_FORMAT_RGB565))
+	{
+		res = read_rgb565_asset(src.entry, output_buffer, output_pixels, band_rows, callback);
+	}
+	else if (src.entry != NULL)
+	{
+		res = read_bmp_file(&src, output_buffer, output_pixels, band_rows, callback);
+	}
+	else
+	{
+		strcat(str, path);
+		ESP_LOGI(TAG, "Reading file %s", str);
+		src.f = fopen(str, "r");
+
+		if (src.f == NULL)
+		{
+			ESP_LOGE(TAG, "Failed to open file for reading");
+		}
+		else
+		{
+			res = read_bmp_file(&src, output_buffer, output_pixels, band_rows, callback);
+			fclose(src.f);
+		}
+	}
+
+	xSemaphoreGive(priv_read_lock);
+	return res;
 }
 
 /*********** Private functions ***********/
 
 
-static esp_err_t read_bmp_file(const char *path, uint16_t * output_buffer)
+static esp_err_t read_bmp_file(const BmpSource_T * src, uint16_t * output_buffer, uint32_t output_pixels, int band_rows, sdCard_RowsReadyCallback_T callback)
 {
-	BMPHeader header;
-	FILE *f;
-	uint16_t line_stride;
-	uint16_t line_px_data_len;
-	uint16_t * dest_ptr = output_buffer;
+	BmpSource_T band_src = *src;
+	BmpStreamInfo_T info;
+	BmpStreamConfig_T config;
+	int res;
+
+	res = bmpStream_readInfo(bmp_read_callback, &band_src, &info);
+	if (res != BMPSTREAM_OK)
+	{
+		ESP_LOGE(TAG, "Unsupported bitmap (%d)", res);
+		return ESP_FAIL;
+	}
+
+	ESP_LOGI(TAG, "Bitmap %ldx%ld, %d bits per pixel", (long)info.width, (long)info.height, info.bits_per_pixel);
+
+	if (((uint64_t)info.width * (uint64_t)info.height) > output_pixels)
+	{
+		ESP_LOGE(TAG, "Bitmap does not fit in the %lu pixel buffer", (unsigned long)output_pixels);
+		return ESP_FAIL;
+	}
+
+	band_src.callback = callback;
+
+	memset(&config, 0, sizeof(config));
+	config.read = bmp_read_callback;
+	config.read_ctx = &band_src;
+	config.sink = (callback != NULL) ? bmp_band_callback : NULL;
+	config.sink_ctx = &band_src;
+	config.line_buf = bmp_line_buffer;
+	config.line_buf_words = MAX_BMP_LINE_LENGTH;
+	config.band_buf = output_buffer;
+	config.band_buf_pixels = (uint32_t)info.width * info.height;
+	config.is_whole_image = true;
+	config.band_rows = band_rows;
+	config.format = BMPSTREAM_PIXELS_DISPLAY;
+
+	res = bmpStream_decode(&config, NULL);
+	if (res != BMPSTREAM_OK)
+	{
+		ESP_LOGE(TAG, "Failed to decode bitmap (%d)", res);
+		return ESP_FAIL;
+	}
+
+	return ESP_OK;
+}
 
-	ESP_LOGI(TAG, "Reading file %s", path);
-    f = fopen(path, "r");
 
-    if (f == NULL)
-    {
-        ESP_LOGE(TAG, "Failed to open file for reading");
-        return ESP_FAIL;
-    }
+/* Pre-converted pixels need no line buffer, they are read straight into the output buffer one band at a time. */
+static esp_err_t read_rgb565_asset(const AssetPackEntry_T * entry, uint16_t * output_buffer, uint32_t output_pixels, int band_rows, sdCard_RowsReadyCallback_T callback)
+{
+	uint32_t row_bytes = entry->width * sizeof(uint16_t);
+	int rows;
+
+	ESP_LOGI(TAG, "Reading %s from the asset pack", entry->name);
+
+	if (((uint32_t)entry->width * entry->height) > output_pixels)
+	{
+		ESP_LOGE(TAG, "%s is %dx%d, does not fit in the %lu pixel buffer", entry->name, entry->width, entry->height, (unsigned long)output_pixels);
+		return ESP_FAIL;
+	}
+
+	/* Same as for bitmaps, 0 means the whole image in one go. */
+	if ((callback == NULL) || (band_rows <= 0))
+	{
+		band_rows = entry->height;
+	}
+
+	for (int y = 0; y < entry->height; y += rows)
+	{
+		rows = MIN(band_rows, entry->height - y);
+
+		if (assetPack_read(entry, y * row_bytes, output_buffer + (y * entry->width), rows * row_bytes) != ESP_OK)
+		{
+			return ESP_FAIL;
+		}
+
+		if (callback != NULL)
+		{
+			callback(y, rows);
+		}
+	}
+
+	return ESP_OK;
+}
 
-    fread(&header, sizeof(BMPHeader), 1u, f);
 
-    ESP_LOGE(TAG, "Bitmap width : %ld", header.width_px);
-    ESP_LOGE(TAG, "Bitmap height : %ld", header.height_px);
+static esp_err_t source_read(const BmpSource_T * src, uint32_t offset, void * buf, uint32_t len)
+{
+	if (src->entry != NULL)
+	{
+		return assetPack_read(src->entry, offset, buf, len);
+	}
 
-    /* Take padding into account... */
-    line_px_data_len = header.width_px * 3u;
-    line_stride = (line_px_data_len + 3u) & ~0x03;
+	if ((fseek(src->f, offset, SEEK_SET) != 0) || (fread(buf, sizeof(uint8_t), len, src->f) != len))
+	{
+		return ESP_FAIL;
+	}
 
-    for (int y = 0u; y < header.height_px; y++)
-    {
-    	fseek(f, ((header.height_px - (y + 1)) * line_stride) + header.offset, SEEK_SET);
-    	fread(bmp_line_buffer, sizeof(uint8_t), line_stride, f);
+	return ESP_OK;
+}
 
-      for (int x = 0u; x < line_px_data_len; x+=3u )
-      {
-        *dest_ptr++ = CONVERT_888RGB_TO_565RGB(bmp_line_buffer[x + 2], bmp_line_buffer[x+1], bmp_line_buffer[x]);
-      }
-    }
 
-    fclose(f);
+static int bmp_read_callback(void * ctx, uint32_t offset, void * buf, uint32_t len)
+{
+	TRACE_SCOPE("sd_read_line");
+	return (source_read((const BmpSource_T *)ctx, offset, buf, len) == ESP_OK) ? 0 : -1;
+}
 
-    return ESP_OK;
+
+static void bmp_band_callback(void * ctx, int first_row, int number_of_rows, int width, uint16_t * pixels)
+{
+	((const BmpSource_T *)ctx)->callback(first_row, number_of_rows);
 }
@@ -8,7 +8,20 @@
 #ifndef MAIN_SDCARD_H_
 #define MAIN_SDCARD_H_
 
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/* Called each time a band of rows has been decoded into the output buffer. */
+typedef void (*sdCard_RowsReadyCallback_T)(int first_row, int number_of_rows);
+
 extern void sdCard_init(void);
-extern void sdCard_Read_bmp_file(const char *path, uint16_t * output_buffer);
+
+/* Reads a bitmap into output_buffer, which holds output_pixels pixels. Images that do not fit are not read. */
+extern esp_err_t sdCard_Read_bmp_file(const char *path, uint16_t * output_buffer, uint32_t output_pixels);
+
+/* Same as sdCard_Read_bmp_file, but calls the callback after every band_rows rows, so the image can be shown while it is still loading.
+ * band_rows 0 reads the whole image before calling the callback once. */
+extern esp_err_t sdCard_Read_bmp_file_progressive(const char *path, uint16_t * output_buffer, uint32_t output_pixels, int band_rows, sdCard_RowsReadyCallback_T callback);
 
 #endif /* MAIN_SDCARD_H_ */
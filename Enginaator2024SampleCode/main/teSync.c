@@ -0,0 +1,221 @@
+/*
+ * teSync.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+
+#include "sdkconfig.h"
+
+#ifdef CONFIG_DISPLAY_TE_SYNC
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#ifndef CONFIG_DISPLAY_TE_SIMULATED
+#include "driver/gpio.h"
+#endif
+
+#include "teSync.h"
+
+/****************** Private defines *******************/
+
+#define SCAN_PERIOD_US CONFIG_DISPLAY_SCAN_PERIOD_US
+
+/* Number of points at which teSync_checkWrite compares the write and scan positions. */
+#define CHECK_STEPS 64
+
+/**************** Private function forward declarations **************/
+
+static void IRAM_ATTR teEdge(void);
+#ifdef CONFIG_DISPLAY_TE_SIMULATED
+static void simulatedTeCallback(void * param);
+#else
+static void IRAM_ATTR teIsrHandler(void * param);
+#endif
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "TE Sync";
+
+static SemaphoreHandle_t priv_te_semaphore;
+/* 64 bits, so written by the edge and read by the flush task under the lock. */
+static int64_t priv_last_te_us = 0;
+static portMUX_TYPE priv_te_lock = portMUX_INITIALIZER_UNLOCKED;
+static TeSyncCounters_T priv_counters;
+
+/**************** Public functions  **************/
+
+void teSync_init(void)
+{
+	priv_te_semaphore = xSemaphoreCreateBinary();
+	assert(priv_te_semaphore);
+
+#ifdef CONFIG_DISPLAY_TE_SIMULATED
+	/* Stand-in for the panel : a pulse every refresh period. */
+	const esp_timer_create_args_t te_timer_args =
+	{
+		.callback = &simulatedTeCallback,
+		.name = "TE stand-in"
+	};
+	esp_timer_handle_t te_timer;
+
+	ESP_ERROR_CHECK(esp_timer_create(&te_timer_args, &te_timer));
+	ESP_ERROR_CHECK(esp_timer_start_periodic(te_timer, SCAN_PERIOD_US));
+
+	ESP_LOGI(TAG, "Using simulated TE, period %d us", SCAN_PERIOD_US);
+#else
+	gpio_config_t io_conf = {};
+	io_conf.pin_bit_mask = (1ULL << CONFIG_DISPLAY_TE_PIN);
+	io_conf.mode = GPIO_MODE_INPUT;
+	io_conf.intr_type = GPIO_INTR_POSEDGE;
+	ESP_ERROR_CHECK(gpio_config(&io_conf));
+
+	/* The service may already be installed by someone else, that is fine. */
+	gpio_install_isr_service(0);
+	ESP_ERROR_CHECK(gpio_isr_handler_add(CONFIG_DISPLAY_TE_PIN, teIsrHandler, NULL));
+
+	ESP_LOGI(TAG, "Using TE on GPIO %d", CONFIG_DISPLAY_TE_PIN);
+#endif
+}
+
+
+bool teSync_waitForTe(void)
+{
+	/* Drop an edge that came while nobody was waiting, the transfer must start on a fresh one. */
+	xSemaphoreTake(priv_te_semaphore, 0);
+
+	if (xSemaphoreTake(priv_te_semaphore, pdMS_TO_TICKS((2 * SCAN_PERIOD_US) / 1000) + 1) != pdTRUE)
+	{
+		priv_counters.te_timeouts++;
+		return false;
+	}
+
+	return true;
+}
+
+
+uint32_t teSync_getScanLine(int64_t time_us, uint32_t scan_lines)
+{
+	int64_t since_te;
+
+	portENTER_CRITICAL(&priv_te_lock);
+	since_te = time_us - priv_last_te_us;
+	portEXIT_CRITICAL(&priv_te_lock);
+
+	if (since_te < 0)
+	{
+		since_te = 0;
+	}
+
+	return (uint32_t)(((since_te % SCAN_PERIOD_US) * scan_lines) / SCAN_PERIOD_US);
+}
+
+
+bool teSync_checkWrite(int64_t start_us, int64_t end_us)
+{
+	const int32_t lines = 1024;	/* Resolution of the comparison */
+	int64_t duration = end_us - start_us;
+	int64_t t;
+	int32_t write_pos, scan_pos, diff;
+	int32_t prev_scan_pos = -1;
+	int32_t prev_diff = 0;
+	bool isTear = false;
+
+	priv_counters.checked_writes++;
+
+	if (duration <= 0)
+	{
+		return false;
+	}
+
+	/* Write position goes linearly over the panel during the transfer, the scan position over the panel once per period.
+	 * The write crossed the scan if their difference changes sign without the scan wrapping around. A step that lands
+	 * exactly on the scan line keeps the side the write was on before, so the crossing is still seen after it. */
+	for (int step = 0; step <= CHECK_STEPS; step++)
+	{
+		t = start_us + ((duration * step) / CHECK_STEPS);
+		write_pos = (int32_t)(((t - start_us) * lines) / duration);
+		scan_pos = (int32_t)teSync_getScanLine(t, lines);
+		diff = scan_pos - write_pos;
+
+		if ((prev_scan_pos >= 0) && (scan_pos >= prev_scan_pos))
+		{
+			if (((prev_diff < 0) && (diff > 0)) || ((prev_diff > 0) && (diff < 0)))
+			{
+				isTear = true;
+				break;
+			}
+
+			if (diff != 0)
+			{
+				prev_diff = diff;
+			}
+		}
+		else
+		{
+			/* First step or the scan wrapped around, start over from here. */
+			prev_diff = diff;
+		}
+
+		prev_scan_pos = scan_pos;
+	}
+
+	if (isTear)
+	{
+		priv_counters.tear_risks++;
+	}
+
+	return isTear;
+}
+
+
+void teSync_getCounters(TeSyncCounters_T * counters)
+{
+	*counters = priv_counters;
+}
+
+
+void teSync_printCounters(void)
+{
+	ESP_LOGI(TAG, "TE edges %lu, timeouts %lu. Checked writes %lu, tear risks %lu",
+			(unsigned long)priv_counters.te_edges,
+			(unsigned long)priv_counters.te_timeouts,
+			(unsigned long)priv_counters.checked_writes,
+			(unsigned long)priv_counters.tear_risks);
+}
+
+/*********** Private functions ***********/
+
+/* Runs from the pin interrupt or from the esp_timer task, so it must be in IRAM and take the lock either way. */
+static void IRAM_ATTR teEdge(void)
+{
+	int64_t now_us = esp_timer_get_time();
+
+	portENTER_CRITICAL_SAFE(&priv_te_lock);
+	priv_last_te_us = now_us;
+	portEXIT_CRITICAL_SAFE(&priv_te_lock);
+
+	priv_counters.te_edges++;
+}
+
+#ifdef CONFIG_DISPLAY_TE_SIMULATED
+static void simulatedTeCallback(void * param)
+{
+	teEdge();
+	xSemaphoreGive(priv_te_semaphore);
+}
+#else
+static void IRAM_ATTR teIsrHandler(void * param)
+{
+	BaseType_t isHigherPriorityTaskWoken = pdFALSE;
+
+	teEdge();
+	xSemaphoreGiveFromISR(priv_te_semaphore, &isHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(isHigherPriorityTaskWoken);
+}
+#endif
+
+#endif /* CONFIG_DISPLAY_TE_SYNC */
@@ -0,0 +1,41 @@
+/*
+ * teSync.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Tearing effect (TE) signal handling. Provides the TE edge, either from the panel's TE pin or
+ *  from a timer stand-in, and a model of the panel scanout position that is used to check whether
+ *  a transfer crossed the scanout.
+ */
+
+#ifndef MAIN_TESYNC_H_
+#define MAIN_TESYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct
+{
+	uint32_t te_edges;
+	uint32_t te_timeouts;
+	uint32_t checked_writes;
+	uint32_t tear_risks;
+} TeSyncCounters_T;
+
+extern void teSync_init(void);
+
+/* Blocks until the next TE edge. Returns false if no edge came within two refresh periods. */
+extern bool teSync_waitForTe(void);
+
+/* Scan position at the given time, 0 ... scan_lines - 1, counted from the last TE edge. */
+extern uint32_t teSync_getScanLine(int64_t time_us, uint32_t scan_lines);
+
+/* Checks whether a transfer that wrote the whole panel linearly from start_us to end_us crossed
+ * the scanout. Returns true if it did, the frame may have shown a tear. */
+extern bool teSync_checkWrite(int64_t start_us, int64_t end_us);
+
+extern void teSync_getCounters(TeSyncCounters_T * counters);
+extern void teSync_printCounters(void);
+
+#endif /* MAIN_TESYNC_H_ */
@@ -0,0 +1,205 @@
+/*
+ * trace.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "sdkconfig.h"
+#include "trace.h"
+
+#ifdef CONFIG_TRACE_ENABLE
+
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+
+#include "memPool.h"
+
+/****************** Private defines *******************/
+
+#define TRACE_FORMAT_VERSION 1
+
+/* The cycle counters of the two cores are not synchronized and wrap every few seconds. Every
+ * this many events the shared microsecond timer is noted too, so the converter can put both
+ * cores on one time line. */
+#define TRACE_SYNC_INTERVAL 256u
+
+#define TRACE_EVENT_SYNC 0xffu
+
+#if portNUM_PROCESSORS > 1
+#define NUMBER_OF_TRACE_CORES portNUM_PROCESSORS
+#define TRACE_CORE_ID() xPortGetCoreID()
+#else
+#define NUMBER_OF_TRACE_CORES 1
+#define TRACE_CORE_ID() 0
+#endif
+
+/****************** Private type definitions *******************/
+
+typedef struct
+{
+	union
+	{
+		const char * name;
+		uint32_t sync_us;		/* For TRACE_EVENT_SYNC */
+	};
+	uint32_t timestamp;
+	uint8_t type;
+} TraceEvent_T;
+
+typedef struct
+{
+	TraceEvent_T * events;
+	uint32_t head;				/* Total number of events ever written. Only tasks of the owning core write. */
+} TraceRing_T;
+
+/**************** Private function forward declarations **************/
+
+static inline uint32_t getTimestamp(void);
+static uint32_t getTicksPerUs(void);
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Trace";
+
+static TraceRing_T priv_rings[NUMBER_OF_TRACE_CORES];
+static volatile bool priv_isRecording = false;
+
+/**************** Public functions  **************/
+
+void trace_init(void)
+{
+	MemPoolArena_T * arena = memPool_createArena("trace", MEMPOOL_REGION_INTERNAL,
+			NUMBER_OF_TRACE_CORES * CONFIG_TRACE_BUFFER_EVENTS * sizeof(TraceEvent_T));
+
+	if (arena == NULL)
+	{
+		ESP_LOGE(TAG, "No memory for the trace buffers, tracing disabled");
+		return;
+	}
+
+	for (int x = 0; x < NUMBER_OF_TRACE_CORES; x++)
+	{
+		memset(&priv_rings[x], 0, sizeof(TraceRing_T));
+		priv_rings[x].events = memPool_alloc(arena, CONFIG_TRACE_BUFFER_EVENTS * sizeof(TraceEvent_T));
+	}
+
+	priv_isRecording = true;
+}
+
+
+void trace_record(const char * name, TraceEventType_T type)
+{
+	TraceRing_T * ring;
+	TraceEvent_T * event;
+	uint32_t ix;
+
+	if (!priv_isRecording)
+	{
+		return;
+	}
+
+	ring = &priv_rings[TRACE_CORE_ID()];
+
+	/* Tasks on the same core can preempt each other, so the slot is reserved atomically. */
+	ix = __atomic_fetch_add(&ring->head, 1u, __ATOMIC_RELAXED);
+
+	if ((ix % TRACE_SYNC_INTERVAL) == 0u)
+	{
+		event = &ring->events[ix % CONFIG_TRACE_BUFFER_EVENTS];
+		event->sync_us = (uint32_t)esp_timer_get_time();
+		event->type = TRACE_EVENT_SYNC;
+		event->timestamp = getTimestamp();
+
+		ix = __atomic_fetch_add(&ring->head, 1u, __ATOMIC_RELAXED);
+	}
+
+	event = &ring->events[ix % CONFIG_TRACE_BUFFER_EVENTS];
+	event->name = name;
+	event->type = type;
+	event->timestamp = getTimestamp();
+}
+
+
+void trace_dump(FILE * f)
+{
+	uint32_t ticks_per_us = getTicksPerUs();
+
+	/* Stop recording so the buffers do not change while they are written out. */
+	priv_isRecording = false;
+
+	fprintf(f, "# enginaator trace\n");
+	fprintf(f, "V %d\n", TRACE_FORMAT_VERSION);
+	fprintf(f, "T %lu\n", (unsigned long)ticks_per_us);
+
+	for (int core = 0; core < NUMBER_OF_TRACE_CORES; core++)
+	{
+		TraceRing_T * ring = &priv_rings[core];
+		uint32_t count = (ring->head < CONFIG_TRACE_BUFFER_EVENTS) ? ring->head : CONFIG_TRACE_BUFFER_EVENTS;
+
+		for (uint32_t ix = ring->head - count; ix != ring->head; ix++)
+		{
+			TraceEvent_T * event = &ring->events[ix % CONFIG_TRACE_BUFFER_EVENTS];
+
+			if (event->type == TRACE_EVENT_SYNC)
+			{
+				fprintf(f, "S %d %lu %lu\n", core, (unsigned long)event->timestamp, (unsigned long)event->sync_us);
+				continue;
+			}
+
+			fprintf(f, "E %d %lu %c %s\n",
+					core,
+					(unsigned long)event->timestamp,
+					(event->type == TRACE_EVENT_BEGIN) ? 'B' : 'E',
+					event->name);
+		}
+	}
+
+	priv_isRecording = true;
+}
+
+
+void trace_dumpToFile(void)
+{
+	FILE * f;
+
+	if (strlen(CONFIG_TRACE_FILE) == 0u)
+	{
+		trace_dump(stdout);
+		return;
+	}
+
+	f = fopen(CONFIG_TRACE_FILE, "w");
+
+	if (f == NULL)
+	{
+		ESP_LOGE(TAG, "Failed to open %s", CONFIG_TRACE_FILE);
+		return;
+	}
+
+	trace_dump(f);
+	fclose(f);
+
+	ESP_LOGI(TAG, "Trace written to %s", CONFIG_TRACE_FILE);
+}
+
+/*********** Private functions ***********/
+
+static inline uint32_t getTimestamp(void)
+{
+	return esp_cpu_get_cycle_count();
+}
+
+static uint32_t getTicksPerUs(void)
+{
+	return esp_rom_get_cpu_ticks_per_us();
+}
+
+#endif /* CONFIG_TRACE_ENABLE */
@@ -0,0 +1,68 @@
+/*
+ * trace.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Lightweight hot path tracing. TRACE_SCOPE("name") records a begin event with the cycle counter
+ *  and a matching end event when the enclosing block is left. Events go into a ring buffer of the
+ *  core that runs the code, without locking. Everything compiles away unless CONFIG_TRACE_ENABLE is set.
+ *  Names must be string literals, only the pointer is stored.
+ */
+
+#ifndef MAIN_TRACE_H_
+#define MAIN_TRACE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#ifdef CONFIG_TRACE_ENABLE
+
+typedef enum
+{
+	TRACE_EVENT_BEGIN,
+	TRACE_EVENT_END,
+} TraceEventType_T;
+
+typedef const char * TraceScope_T;
+
+extern void trace_init(void);
+extern void trace_record(const char * name, TraceEventType_T type);
+
+/* Writes all buffered events. In the compact text format for tools/trace_to_chrome.py. */
+extern void trace_dump(FILE * f);
+
+/* Dumps to CONFIG_TRACE_FILE, or to the console if it is empty. */
+extern void trace_dumpToFile(void);
+
+static inline TraceScope_T trace_scopeBegin(const char * name)
+{
+	trace_record(name, TRACE_EVENT_BEGIN);
+	return name;
+}
+
+static inline void trace_scopeEnd(TraceScope_T * scope)
+{
+	trace_record(*scope, TRACE_EVENT_END);
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#define TRACE_SCOPE(name) TraceScope_T TRACE_CONCAT(trace_scope_, __LINE__) __attribute__((cleanup(trace_scopeEnd), unused)) = trace_scopeBegin(name)
+#define TRACE_BEGIN(name) trace_record((name), TRACE_EVENT_BEGIN)
+#define TRACE_END(name)   trace_record((name), TRACE_EVENT_END)
+
+#else
+
+#define trace_init()        ((void)0)
+#define trace_dumpToFile()  ((void)0)
+#define TRACE_SCOPE(name)   ((void)0)
+#define TRACE_BEGIN(name)   ((void)0)
+#define TRACE_END(name)     ((void)0)
+
+#endif /* CONFIG_TRACE_ENABLE */
+
+#endif /* MAIN_TRACE_H_ */
@@ -0,0 +1,439 @@
+/*
+ * videoPlayer.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "videoPlayer.h"
+#include "display.h"
+#include "trace.h"
+
+/****************** Private defines *******************/
+
+#define VIDEO_MAGIC 	0x44495645u  /* "EVID" */
+#define VIDEO_VERSION 	1u
+
+#define VIDEO_FRAME_KEY		1u	/* Payload is the whole frame, top down, in the display format. */
+#define VIDEO_FRAME_DELTA	2u	/* Payload is a list of rectangles, each a VideoRect_T followed by its pixels. */
+
+#define VIDEO_MAX_SLOTS		4
+
+/* Rectangle pixel data is padded to a multiple of this, so every rectangle starts DMA aligned. */
+#define VIDEO_RECT_ALIGNMENT 4u
+
+/* Marks the end of the file in the ready queue. */
+#define VIDEO_SLOT_END	(-1)
+
+#define READER_TASK_STACK_SIZE	4096
+#define READER_TASK_PRIORITY	5
+
+/* Speed of the stand-in panel, same as the SPI clock in display.c */
+#define STAND_IN_SPI_HZ		(40u * 1000u * 1000u)
+
+/****************** Private type definitions *******************/
+
+#pragma pack(push)
+#pragma pack(1)
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t width;
+	uint16_t height;
+	uint16_t fps;
+	uint16_t keyframe_interval;
+	uint16_t reserved;
+	uint32_t frame_count;
+	uint32_t reserved2;
+} VideoHeader_T;
+
+typedef struct
+{
+	uint32_t payload_size;
+	uint8_t type;
+	uint8_t reserved;
+	uint16_t rect_count;
+} VideoFrameHeader_T;
+
+typedef struct
+{
+	uint16_t x;
+	uint16_t y;
+	uint16_t width;
+	uint16_t height;
+} VideoRect_T;
+#pragma pack(pop)
+
+/* Passed from the reader to the player. */
+typedef struct
+{
+	int slot;
+	uint32_t index;
+	uint32_t payload_size;
+	uint8_t type;
+	uint16_t rect_count;
+	bool isError;		/* Only set on the end marker */
+} VideoFrame_T;
+
+/**************** Private function forward declarations **************/
+
+static void priv_readerTask(void * param);
+static bool priv_drawFrame(const VideoFrame_T * frame, uint8_t * data, const VideoSink_T * sink);
+static void standIn_drawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t * pixels);
+static void standIn_waitDone(void);
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Video Player";
+
+static QueueHandle_t priv_free_queue;
+static QueueHandle_t priv_ready_queue;
+
+/* Reader state, only valid during videoPlayer_play */
+static int priv_fd = -1;
+static uint8_t * const * priv_slots;
+static size_t priv_slot_size;
+static uint32_t priv_frame_size;
+static volatile bool priv_skip_to_key;
+static volatile uint32_t priv_reader_skipped;
+
+/* Stand-in panel : the time its current transfer finishes. */
+static int64_t priv_stand_in_busy_until_us = 0;
+
+/**************** Public variable declarations ******************/
+
+const VideoSink_T videoPlayer_displaySink =
+{
+	.width = DISPLAY_WIDTH,
+	.height = DISPLAY_HEIGHT,
+	.drawRect = display_drawBitmap,
+	.waitDone = display_waitTransferDone,
+};
+
+const VideoSink_T videoPlayer_standInSink =
+{
+	.width = DISPLAY_WIDTH,
+	.height = DISPLAY_HEIGHT,
+	.drawRect = standIn_drawRect,
+	.waitDone = standIn_waitDone,
+};
+
+/**************** Public functions  **************/
+
+esp_err_t videoPlayer_play(const char * path, uint8_t * const * slots, int number_of_slots, size_t slot_size,
+		const VideoSink_T * sink, VideoStats_T * stats)
+{
+	VideoHeader_T header;
+	VideoFrame_T frame;
+	VideoStats_T result;
+	int64_t start_us;
+	int64_t due_us;
+	int64_t now_us;
+	uint32_t period_us;
+	int prev_slot = VIDEO_SLOT_END;
+	bool isWaitingForKey = false;
+	esp_err_t ret = ESP_OK;
+
+	memset(&result, 0, sizeof(result));
+
+	if ((number_of_slots < 2) || (number_of_slots > VIDEO_MAX_SLOTS))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	priv_fd = open(path, O_RDONLY);
+	if (priv_fd < 0)
+	{
+		ESP_LOGI(TAG, "No video at %s", path);
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	if ((read(priv_fd, &header, sizeof(header)) != sizeof(header)) || (header.magic != VIDEO_MAGIC) || (header.version != VIDEO_VERSION))
+	{
+		ESP_LOGE(TAG, "%s is not a valid video", path);
+		close(priv_fd);
+		priv_fd = -1;
+		return ESP_FAIL;
+	}
+
+	priv_frame_size = (uint32_t)header.width * header.height * sizeof(uint16_t);
+
+	if ((header.width != sink->width) || (header.height != sink->height) || (header.fps == 0u) || (priv_frame_size > slot_size))
+	{
+		ESP_LOGE(TAG, "Video is %dx%d at %d fps, does not fit the %dx%d screen or the %u byte slots",
+				header.width, header.height, header.fps, sink->width, sink->height, (unsigned)slot_size);
+		close(priv_fd);
+		priv_fd = -1;
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	if (priv_free_queue == NULL)
+	{
+		priv_free_queue = xQueueCreate(VIDEO_MAX_SLOTS, sizeof(int));
+		priv_ready_queue = xQueueCreate(VIDEO_MAX_SLOTS + 1, sizeof(VideoFrame_T));
+		assert(priv_free_queue && priv_ready_queue);
+	}
+
+	priv_slots = slots;
+	priv_slot_size = slot_size;
+	priv_skip_to_key = false;
+	priv_reader_skipped = 0u;
+
+	for (int ix = 0; ix < number_of_slots; ix++)
+	{
+		xQueueSend(priv_free_queue, &ix, 0);
+	}
+
+	ESP_LOGI(TAG, "Playing %s, %lu frames at %d fps", path, (unsigned long)header.frame_count, header.fps);
+
+	period_us = 1000000u / header.fps;
+	start_us = esp_timer_get_time();
+
+	xTaskCreate(priv_readerTask, "video_reader", READER_TASK_STACK_SIZE, NULL, READER_TASK_PRIORITY, NULL);
+
+	while(1)
+	{
+		xQueueReceive(priv_ready_queue, &frame, portMAX_DELAY);
+
+		if (frame.slot == VIDEO_SLOT_END)
+		{
+			result.frames_total = frame.index;
+			if (frame.isError)
+			{
+				ret = ESP_FAIL;
+			}
+			break;
+		}
+
+		due_us = start_us + ((int64_t)frame.index * period_us);
+		now_us = esp_timer_get_time();
+
+		/* More than a frame behind : drop delta frames until the next keyframe, which does not depend on them. */
+		if ((frame.type == VIDEO_FRAME_DELTA) && (isWaitingForKey || (now_us > (due_us + period_us))))
+		{
+			isWaitingForKey = true;
+			priv_skip_to_key = true;
+			result.frames_dropped++;
+			xQueueSend(priv_free_queue, &frame.slot, portMAX_DELAY);
+			continue;
+		}
+
+		isWaitingForKey = false;
+
+		if (now_us < due_us)
+		{
+			vTaskDelay((TickType_t)((due_us - now_us) / (portTICK_PERIOD_MS * 1000)));
+		}
+		else if (now_us > (due_us + period_us))
+		{
+			result.late_frames++;
+		}
+
+		/* The previous slot can be reused once its transfer is done. */
+		TRACE_BEGIN("video_frame");
+		sink->waitDone();
+
+		if (prev_slot != VIDEO_SLOT_END)
+		{
+			xQueueSend(priv_free_queue, &prev_slot, portMAX_DELAY);
+		}
+
+		if (!priv_drawFrame(&frame, slots[frame.slot], sink))
+		{
+			ESP_LOGE(TAG, "Frame %lu is corrupt", (unsigned long)frame.index);
+		}
+
+		prev_slot = frame.slot;
+		result.frames_shown++;
+		TRACE_END("video_frame");
+	}
+
+	/* The last frame is shown for a whole period too. */
+	due_us = start_us + ((int64_t)result.frames_total * period_us);
+	now_us = esp_timer_get_time();
+	if (now_us < due_us)
+	{
+		vTaskDelay((TickType_t)((due_us - now_us) / (portTICK_PERIOD_MS * 1000)));
+	}
+
+	sink->waitDone();
+
+	/* The reader has ended, release the slots for the next call. */
+	xQueueReset(priv_free_queue);
+	xQueueReset(priv_ready_queue);
+	close(priv_fd);
+	priv_fd = -1;
+
+	result.frames_dropped += priv_reader_skipped;
+	result.elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+	if (result.elapsed_ms > 0u)
+	{
+		result.fps_x100 = (uint32_t)(((uint64_t)result.frames_shown * 100000u) / result.elapsed_ms);
+	}
+
+	ESP_LOGI(TAG, "Shown %lu of %lu frames in %lu ms, %lu.%02lu fps (target %d). Dropped %lu, late %lu",
+			(unsigned long)result.frames_shown,
+			(unsigned long)result.frames_total,
+			(unsigned long)result.elapsed_ms,
+			(unsigned long)(result.fps_x100 / 100u),
+			(unsigned long)(result.fps_x100 % 100u),
+			header.fps,
+			(unsigned long)result.frames_dropped,
+			(unsigned long)result.late_frames);
+
+	if (stats != NULL)
+	{
+		*stats = result;
+	}
+
+	return ret;
+}
+
+/*********** Private functions ***********/
+
+/* Reads ahead into free slots until the end of the file. Delta frames are skipped without reading while the player waits for a keyframe. */
+static void priv_readerTask(void * param)
+{
+	VideoFrameHeader_T frame_header;
+	VideoFrame_T frame;
+	uint32_t index = 0u;
+	int slot;
+	ssize_t res;
+
+	memset(&frame, 0, sizeof(frame));
+
+	while(1)
+	{
+		res = read(priv_fd, &frame_header, sizeof(frame_header));
+
+		if (res == 0)
+		{
+			/* End of the file */
+			break;
+		}
+
+		if ((res != sizeof(frame_header)) || (frame_header.payload_size > priv_slot_size) ||
+			((frame_header.type != VIDEO_FRAME_KEY) && (frame_header.type != VIDEO_FRAME_DELTA)) ||
+			((frame_header.type == VIDEO_FRAME_KEY) && (frame_header.payload_size != priv_frame_size)))
+		{
+			ESP_LOGE(TAG, "Bad frame header at frame %lu", (unsigned long)index);
+			frame.isError = true;
+			break;
+		}
+
+		if (frame_header.type == VIDEO_FRAME_KEY)
+		{
+			priv_skip_to_key = false;
+		}
+		else if (priv_skip_to_key)
+		{
+			lseek(priv_fd, frame_header.payload_size, SEEK_CUR);
+			priv_reader_skipped++;
+			index++;
+			continue;
+		}
+
+		xQueueReceive(priv_free_queue, &slot, portMAX_DELAY);
+
+		TRACE_BEGIN("video_read");
+		res = read(priv_fd, priv_slots[slot], frame_header.payload_size);
+		TRACE_END("video_read");
+
+		if (res != (ssize_t)frame_header.payload_size)
+		{
+			ESP_LOGE(TAG, "Failed to read frame %lu", (unsigned long)index);
+			frame.isError = true;
+			break;
+		}
+
+		frame.slot = slot;
+		frame.index = index;
+		frame.payload_size = frame_header.payload_size;
+		frame.type = frame_header.type;
+		frame.rect_count = frame_header.rect_count;
+
+		xQueueSend(priv_ready_queue, &frame, portMAX_DELAY);
+		index++;
+	}
+
+	frame.slot = VIDEO_SLOT_END;
+	frame.index = index;
+	xQueueSend(priv_ready_queue, &frame, portMAX_DELAY);
+
+	vTaskDelete(NULL);
+}
+
+
+static bool priv_drawFrame(const VideoFrame_T * frame, uint8_t * data, const VideoSink_T * sink)
+{
+	const VideoRect_T * rect;
+	uint32_t offset = 0u;
+	uint32_t pixel_bytes;
+
+	if (frame->type == VIDEO_FRAME_KEY)
+	{
+		sink->drawRect(0, 0, sink->width, sink->height, (uint16_t *)data);
+		return true;
+	}
+
+	for (int ix = 0; ix < frame->rect_count; ix++)
+	{
+		if ((offset + sizeof(VideoRect_T)) > frame->payload_size)
+		{
+			return false;
+		}
+
+		rect = (const VideoRect_T *)(data + offset);
+		offset += sizeof(VideoRect_T);
+
+		pixel_bytes = (uint32_t)rect->width * rect->height * sizeof(uint16_t);
+
+		if (((rect->x + rect->width) > sink->width) || ((rect->y + rect->height) > sink->height) ||
+			((offset + pixel_bytes) > frame->payload_size))
+		{
+			return false;
+		}
+
+		if (pixel_bytes > 0u)
+		{
+			sink->drawRect(rect->x, rect->y, rect->width, rect->height, (uint16_t *)(data + offset));
+		}
+
+		offset += (pixel_bytes + VIDEO_RECT_ALIGNMENT - 1u) & ~(VIDEO_RECT_ALIGNMENT - 1u);
+	}
+
+	return true;
+}
+
+
+/* Like display_drawBitmap : waits for the previous transfer, then starts this one. */
+static void standIn_drawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t * pixels)
+{
+	uint64_t transfer_us = ((uint64_t)width * height * 16u * 1000000u) / STAND_IN_SPI_HZ;
+
+	standIn_waitDone();
+	priv_stand_in_busy_until_us = esp_timer_get_time() + (int64_t)transfer_us;
+}
+
+
+static void standIn_waitDone(void)
+{
+	int64_t now_us = esp_timer_get_time();
+
+	if (priv_stand_in_busy_until_us > now_us)
+	{
+		vTaskDelay((TickType_t)(((priv_stand_in_busy_until_us - now_us) / (portTICK_PERIOD_MS * 1000)) + 1));
+	}
+}
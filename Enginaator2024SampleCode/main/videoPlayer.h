@@ -0,0 +1,53 @@
+/*
+ * videoPlayer.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Streaming playback of full screen animations from the SD card. The file is a sequence of
+ *  keyframes and delta frames (changed rectangles only), built by tools/make_video.py.
+ *  A reader task loads the next frames into free slots while the current one is being sent
+ *  to the display, and the player drops delta frames up to the next keyframe when it falls behind.
+ */
+
+#ifndef MAIN_VIDEOPLAYER_H_
+#define MAIN_VIDEOPLAYER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+
+/* Where the frames go. drawRect may return before the pixels are sent, but the pixels
+ * must not be needed any more once waitDone returns. */
+typedef struct
+{
+	uint16_t width;
+	uint16_t height;
+	void (*drawRect)(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t * pixels);
+	void (*waitDone)(void);
+} VideoSink_T;
+
+typedef struct
+{
+	uint32_t frames_total;
+	uint32_t frames_shown;
+	uint32_t frames_dropped;
+	uint32_t late_frames;
+	uint32_t elapsed_ms;
+	uint32_t fps_x100;		/* Achieved rate, in 1/100 frames per second */
+} VideoStats_T;
+
+/* Sends frames to the panel through display.c. */
+extern const VideoSink_T videoPlayer_displaySink;
+
+/* Stand-in for the panel that only takes the time the SPI transfer would take. Used by the host test in test/host. */
+extern const VideoSink_T videoPlayer_standInSink;
+
+/* Plays the file at path and returns when it has ended. Each slot must hold a full frame
+ * (width * height * 2 bytes) and be DMA capable when used with the display sink.
+ * stats can be NULL. */
+extern esp_err_t videoPlayer_play(const char * path, uint8_t * const * slots, int number_of_slots, size_t slot_size,
+		const VideoSink_T * sink, VideoStats_T * stats);
+
+#endif /* MAIN_VIDEOPLAYER_H_ */
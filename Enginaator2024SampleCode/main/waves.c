@@ -0,0 +1,561 @@
+/*
+ * waves.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "sdkconfig.h"
+#include "esp_log.h"
+
+#include "waves.h"
+#include "display.h"
+#include "sdCard.h"
+
+/****************** Private defines *******************/
+
+#define MAX_PATHS			16
+#define MAX_WAVES			32
+#define PATH_NAME_LENGTH	16
+#define SCRIPT_LINE_LENGTH	160
+
+#define MAX_ENEMIES			CONFIG_WAVES_MAX_ENEMIES
+#define MAX_PATH_STEPS		CONFIG_WAVES_MAX_PATH_STEPS
+
+#define FP_ONE				(1 << WAVES_FP_SHIFT)
+#define HALF_SIZE			(WAVES_ENEMY_SIZE / 2)
+
+/* The enemy sprite is the ghost bitmap scaled down. White is transparent, as for the ship. */
+#define GHOST_FILE			"/ghost.bmp"
+#define TRANSPARENT_COLOR	0xffffu
+#define FALLBACK_COLOR		COLOR_MAGENTA
+
+/****************** Private type definitions *******************/
+
+typedef struct
+{
+	char name[PATH_NAME_LENGTH];
+	uint16_t start;			/* First entry in the tables */
+	uint16_t length;
+} Path_T;
+
+typedef struct
+{
+	uint32_t start_frame;
+	uint16_t interval;		/* Frames between two enemies */
+	uint16_t count;
+	uint16_t spawned;
+	uint8_t path;
+	int16_t dx;				/* Offset from the path, in pixels */
+	int16_t dy;
+} Wave_T;
+
+/**************** Private function forward declarations **************/
+
+static bool parseLine(char * line, int line_number);
+static bool addPath(const char * name, const char * shape, const char * args);
+static int findPath(const char * name);
+static void sortWaves(void);
+static void loadSprite(MemPoolArena_T * arena);
+static void spawn(const Wave_T * wave);
+
+/**************** Private variable declarations ******************/
+
+static const char *TAG = "Waves";
+
+static Path_T priv_paths[MAX_PATHS];
+static int priv_path_count = 0;
+static uint16_t priv_table_used = 0u;
+
+static Wave_T priv_waves[MAX_WAVES];
+static int priv_wave_count = 0;
+static int priv_first_active_wave = 0;
+static uint32_t priv_frame = 0u;
+
+/* Path tables of all paths, back to back. */
+static int16_t * priv_table_x;
+static int16_t * priv_table_y;
+
+/* The enemy pool, as separate arrays. An enemy is just its position in the tables and where its path ends. */
+static uint16_t * priv_pos;
+static uint16_t * priv_end;
+static int16_t * priv_off_x;
+static int16_t * priv_off_y;
+static uint16_t priv_count = 0u;
+
+static uint16_t * priv_sprite;
+
+static bool priv_is_loaded = false;
+static int priv_first_row;
+static int priv_last_row;
+
+/**************** Public functions  **************/
+
+bool waves_load(MemPoolArena_T * arena, const char * path)
+{
+	char line[SCRIPT_LINE_LENGTH];
+	int line_number = 0;
+	FILE * f;
+
+	priv_is_loaded = false;
+	priv_path_count = 0;
+	priv_wave_count = 0;
+	priv_table_used = 0u;
+	priv_first_active_wave = 0;
+	priv_frame = 0u;
+	priv_count = 0u;
+
+	priv_table_x 	= memPool_alloc(arena, MAX_PATH_STEPS * sizeof(int16_t));
+	priv_table_y 	= memPool_alloc(arena, MAX_PATH_STEPS * sizeof(int16_t));
+	priv_pos 		= memPool_alloc(arena, MAX_ENEMIES * sizeof(uint16_t));
+	priv_end 		= memPool_alloc(arena, MAX_ENEMIES * sizeof(uint16_t));
+	priv_off_x 		= memPool_alloc(arena, MAX_ENEMIES * sizeof(int16_t));
+	priv_off_y 		= memPool_alloc(arena, MAX_ENEMIES * sizeof(int16_t));
+
+	assert(priv_table_x && priv_table_y && priv_pos && priv_end && priv_off_x && priv_off_y);
+
+	f = fopen(path, "r");
+	if (f == NULL)
+	{
+		ESP_LOGW(TAG, "No wave script at %s", path);
+		return false;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL)
+	{
+		line_number++;
+		if (!parseLine(line, line_number))
+		{
+			fclose(f);
+			return false;
+		}
+	}
+
+	fclose(f);
+
+	if (priv_wave_count == 0)
+	{
+		ESP_LOGW(TAG, "%s has no waves", path);
+		return false;
+	}
+
+	sortWaves();
+	loadSprite(arena);
+
+	priv_is_loaded = true;
+	ESP_LOGI(TAG, "%d paths (%u table entries), %d waves", priv_path_count, priv_table_used, priv_wave_count);
+
+	return true;
+}
+
+
+void waves_update(void)
+{
+	uint16_t ix = 0u;
+	int y;
+
+	if (!priv_is_loaded)
+	{
+		return;
+	}
+
+	/* Waves are sorted by start frame. Only the ones that have started and are not fully spawned are looked at. */
+	for (int w = priv_first_active_wave; (w < priv_wave_count) && (priv_waves[w].start_frame <= priv_frame); w++)
+	{
+		Wave_T * wave = &priv_waves[w];
+
+		while ((wave->spawned < wave->count) && (priv_frame >= (wave->start_frame + ((uint32_t)wave->spawned * wave->interval))))
+		{
+			spawn(wave);
+			wave->spawned++;
+		}
+
+		if ((wave->spawned == wave->count) && (w == priv_first_active_wave))
+		{
+			priv_first_active_wave++;
+		}
+	}
+
+	priv_first_row = DISPLAY_HEIGHT;
+	priv_last_row = -1;
+
+	/* Moving is one step along the table. Enemies at the end of their path are replaced by the last one. */
+	while (ix < priv_count)
+	{
+		priv_pos[ix]++;
+
+		if (priv_pos[ix] >= priv_end[ix])
+		{
+			priv_count--;
+			priv_pos[ix] = priv_pos[priv_count];
+			priv_end[ix] = priv_end[priv_count];
+			priv_off_x[ix] = priv_off_x[priv_count];
+			priv_off_y[ix] = priv_off_y[priv_count];
+			continue;
+		}
+
+		y = (priv_table_y[priv_pos[ix]] >> WAVES_FP_SHIFT) + priv_off_y[ix];
+		priv_first_row = MIN(priv_first_row, y - HALF_SIZE);
+		priv_last_row = MAX(priv_last_row, y + HALF_SIZE - 1);
+		ix++;
+	}
+
+	priv_first_row = MAX(priv_first_row, 0);
+	priv_last_row = MIN(priv_last_row, (int)DISPLAY_HEIGHT - 1);
+
+	priv_frame++;
+
+	/* The script starts over once everything has been spawned and has left the screen. */
+	if ((priv_first_active_wave == priv_wave_count) && (priv_count == 0u))
+	{
+		for (int w = 0; w < priv_wave_count; w++)
+		{
+			priv_waves[w].spawned = 0u;
+		}
+		priv_first_active_wave = 0;
+		priv_frame = 0u;
+	}
+}
+
+
+void waves_renderRows(uint16_t * frame_buf, int first_row, int end_row)
+{
+	int x0, y0, x_start, x_end, y_start, y_end;
+	const uint16_t * src;
+	uint16_t * dest;
+
+	first_row = MAX(first_row, priv_first_row);
+	end_row = MIN(end_row, priv_last_row + 1);
+
+	if (first_row >= end_row)
+	{
+		return;
+	}
+
+	for (uint16_t ix = 0u; ix < priv_count; ix++)
+	{
+		x0 = (priv_table_x[priv_pos[ix]] >> WAVES_FP_SHIFT) + priv_off_x[ix] - HALF_SIZE;
+		y0 = (priv_table_y[priv_pos[ix]] >> WAVES_FP_SHIFT) + priv_off_y[ix] - HALF_SIZE;
+
+		y_start = MAX(y0, first_row);
+		y_end = MIN(y0 + WAVES_ENEMY_SIZE, end_row);
+		x_start = MAX(x0, 0);
+		x_end = MIN(x0 + WAVES_ENEMY_SIZE, (int)DISPLAY_WIDTH);
+
+		if ((y_start >= y_end) || (x_start >= x_end))
+		{
+			continue;
+		}
+
+		for (int y = y_start; y < y_end; y++)
+		{
+			src = priv_sprite + ((y - y0) * WAVES_ENEMY_SIZE) + (x_start - x0);
+			dest = frame_buf + (y * DISPLAY_WIDTH) + x_start;
+
+			for (int x = x_start; x < x_end; x++)
+			{
+				if (*src != TRANSPARENT_COLOR)
+				{
+					*dest = *src;
+				}
+				src++;
+				dest++;
+			}
+		}
+	}
+}
+
+
+bool waves_getRows(int * first_row, int * last_row)
+{
+	*first_row = priv_first_row;
+	*last_row = priv_last_row;
+
+	return (priv_count > 0u) && (priv_first_row <= priv_last_row);
+}
+
+
+bool waves_hitTest(int xPos, int yPos)
+{
+	int dx, dy;
+
+	for (uint16_t ix = 0u; ix < priv_count; ix++)
+	{
+		dx = xPos - ((priv_table_x[priv_pos[ix]] >> WAVES_FP_SHIFT) + priv_off_x[ix]);
+		dy = yPos - ((priv_table_y[priv_pos[ix]] >> WAVES_FP_SHIFT) + priv_off_y[ix]);
+
+		if ((dx >= -HALF_SIZE) && (dx < HALF_SIZE) && (dy >= -HALF_SIZE) && (dy < HALF_SIZE))
+		{
+			priv_count--;
+			priv_pos[ix] = priv_pos[priv_count];
+			priv_end[ix] = priv_end[priv_count];
+			priv_off_x[ix] = priv_off_x[priv_count];
+			priv_off_y[ix] = priv_off_y[priv_count];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+uint16_t waves_getCount(void)
+{
+	return priv_count;
+}
+
+/*********** Private functions ***********/
+
+/* Script lines :
+ *   path <name> line   <x0> <y0> <x1> <y1> <frames>
+ *   path <name> sine   <x0> <y0> <x1> <y1> <amplitude> <cycles> <frames>
+ *   path <name> bezier <x0> <y0> <cx0> <cy0> <cx1> <cy1> <x1> <y1> <frames>
+ *   wave <start frame> <path> <count> <interval> [<dx> <dy>]
+ * Everything after a # is a comment. */
+static bool parseLine(char * line, int line_number)
+{
+	char keyword[PATH_NAME_LENGTH];
+	char name[PATH_NAME_LENGTH];
+	char shape[PATH_NAME_LENGTH];
+	char * comment = strchr(line, '#');
+	int args = 0;
+
+	if (comment != NULL)
+	{
+		*comment = '\0';
+	}
+
+	if (sscanf(line, "%15s", keyword) != 1)
+	{
+		return true;
+	}
+
+	if (strcmp(keyword, "path") == 0)
+	{
+		if ((sscanf(line, "path %15s %15s %n", name, shape, &args) < 2) || (args == 0) || !addPath(name, shape, line + args))
+		{
+			ESP_LOGE(TAG, "Line %d : bad path", line_number);
+			return false;
+		}
+	}
+	else if (strcmp(keyword, "wave") == 0)
+	{
+		unsigned long start;
+		unsigned int count, interval;
+		int dx = 0, dy = 0;
+		int path;
+
+		args = sscanf(line, "wave %lu %15s %u %u %d %d", &start, name, &count, &interval, &dx, &dy);
+		path = (args >= 4) ? findPath(name) : -1;
+
+		if ((path < 0) || (count == 0u) || (priv_wave_count >= MAX_WAVES))
+		{
+			ESP_LOGE(TAG, "Line %d : bad wave", line_number);
+			return false;
+		}
+
+		priv_waves[priv_wave_count].start_frame = start;
+		priv_waves[priv_wave_count].path = (uint8_t)path;
+		priv_waves[priv_wave_count].count = (uint16_t)count;
+		priv_waves[priv_wave_count].interval = (uint16_t)interval;
+		priv_waves[priv_wave_count].spawned = 0u;
+		priv_waves[priv_wave_count].dx = (int16_t)dx;
+		priv_waves[priv_wave_count].dy = (int16_t)dy;
+		priv_wave_count++;
+	}
+	else
+	{
+		ESP_LOGE(TAG, "Line %d : unknown keyword %s", line_number, keyword);
+		return false;
+	}
+
+	return true;
+}
+
+
+/* Samples the path once per frame into the tables. This is the only place with floating point and trigonometry. */
+static bool addPath(const char * name, const char * shape, const char * args)
+{
+	float p[8];
+	int frames = 0;
+	int n;
+	Path_T * path;
+	float t, u, x, y;
+
+	if ((priv_path_count >= MAX_PATHS) || (findPath(name) >= 0))
+	{
+		return false;
+	}
+
+	if (strcmp(shape, "line") == 0)
+	{
+		n = sscanf(args, "%f %f %f %f %d", &p[0], &p[1], &p[2], &p[3], &frames);
+		if (n != 5) { return false; }
+	}
+	else if (strcmp(shape, "sine") == 0)
+	{
+		n = sscanf(args, "%f %f %f %f %f %f %d", &p[0], &p[1], &p[2], &p[3], &p[4], &p[5], &frames);
+		if (n != 7) { return false; }
+	}
+	else if (strcmp(shape, "bezier") == 0)
+	{
+		n = sscanf(args, "%f %f %f %f %f %f %f %f %d", &p[0], &p[1], &p[2], &p[3], &p[4], &p[5], &p[6], &p[7], &frames);
+		if (n != 9) { return false; }
+	}
+	else
+	{
+		return false;
+	}
+
+	if ((frames < 2) || ((priv_table_used + frames) > MAX_PATH_STEPS))
+	{
+		ESP_LOGE(TAG, "Path %s : %d frames do not fit, %u of %d table entries used", name, frames, priv_table_used, MAX_PATH_STEPS);
+		return false;
+	}
+
+	path = &priv_paths[priv_path_count++];
+	strncpy(path->name, name, PATH_NAME_LENGTH - 1);
+	path->name[PATH_NAME_LENGTH - 1] = '\0';
+	path->start = priv_table_used;
+	path->length = (uint16_t)frames;
+
+	for (int ix = 0; ix < frames; ix++)
+	{
+		t = (float)ix / (float)(frames - 1);
+		u = 1.0f - t;
+
+		if (strcmp(shape, "bezier") == 0)
+		{
+			x = (u * u * u * p[0]) + (3.0f * u * u * t * p[2]) + (3.0f * u * t * t * p[4]) + (t * t * t * p[6]);
+			y = (u * u * u * p[1]) + (3.0f * u * u * t * p[3]) + (3.0f * u * t * t * p[5]) + (t * t * t * p[7]);
+		}
+		else
+		{
+			x = p[0] + ((p[2] - p[0]) * t);
+			y = p[1] + ((p[3] - p[1]) * t);
+
+			if (strcmp(shape, "sine") == 0)
+			{
+				/* Offset at right angles to the line. */
+				float len = sqrtf(((p[2] - p[0]) * (p[2] - p[0])) + ((p[3] - p[1]) * (p[3] - p[1])));
+				float s = (len > 0.0f) ? (p[4] * sinf(2.0f * (float)M_PI * p[5] * t) / len) : 0.0f;
+
+				x -= (p[3] - p[1]) * s;
+				y += (p[2] - p[0]) * s;
+			}
+		}
+
+		priv_table_x[priv_table_used] = (int16_t)lrintf(x * FP_ONE);
+		priv_table_y[priv_table_used] = (int16_t)lrintf(y * FP_ONE);
+		priv_table_used++;
+	}
+
+	return true;
+}
+
+
+static int findPath(const char * name)
+{
+	for (int ix = 0; ix < priv_path_count; ix++)
+	{
+		if (strcmp(priv_paths[ix].name, name) == 0)
+		{
+			return ix;
+		}
+	}
+
+	return -1;
+}
+
+
+/* By start frame, so the update only has to look at the front of the list. Keeps the script order for equal frames. */
+static void sortWaves(void)
+{
+	Wave_T tmp;
+
+	for (int ix = 1; ix < priv_wave_count; ix++)
+	{
+		tmp = priv_waves[ix];
+		int j = ix - 1;
+
+		while ((j >= 0) && (priv_waves[j].start_frame > tmp.start_frame))
+		{
+			priv_waves[j + 1] = priv_waves[j];
+			j--;
+		}
+
+		priv_waves[j + 1] = tmp;
+	}
+}
+
+
+/* Scales the ghost bitmap down to the enemy size. Without it, enemies are plain squares. */
+static void loadSprite(MemPoolArena_T * arena)
+{
+	const int step = WAVES_GHOST_SIZE / WAVES_ENEMY_SIZE;
+	uint16_t * ghost;
+	size_t mark;
+	bool is_visible = false;
+
+	priv_sprite = memPool_alloc(arena, WAVES_ENEMY_SIZE * WAVES_ENEMY_SIZE * sizeof(uint16_t));
+	assert(priv_sprite);
+
+	/* The full size bitmap is only needed until it has been scaled down. */
+	mark = memPool_getMark(arena);
+	ghost = memPool_alloc(arena, WAVES_GHOST_SIZE * WAVES_GHOST_SIZE * sizeof(uint16_t));
+
+	if (ghost != NULL)
+	{
+		for (int ix = 0; ix < (WAVES_GHOST_SIZE * WAVES_GHOST_SIZE); ix++)
+		{
+			ghost[ix] = TRANSPARENT_COLOR;
+		}
+
+		if (sdCard_Read_bmp_file(GHOST_FILE, ghost, WAVES_GHOST_SIZE * WAVES_GHOST_SIZE) == ESP_OK)
+		{
+			for (int y = 0; y < WAVES_ENEMY_SIZE; y++)
+			{
+				for (int x = 0; x < WAVES_ENEMY_SIZE; x++)
+				{
+					priv_sprite[(y * WAVES_ENEMY_SIZE) + x] = ghost[(y * step * WAVES_GHOST_SIZE) + (x * step)];
+					is_visible |= (priv_sprite[(y * WAVES_ENEMY_SIZE) + x] != TRANSPARENT_COLOR);
+				}
+			}
+		}
+
+		memPool_release(arena, mark);
+	}
+
+	if (!is_visible)
+	{
+		ESP_LOGW(TAG, "No enemy sprite, using squares");
+		for (int ix = 0; ix < (WAVES_ENEMY_SIZE * WAVES_ENEMY_SIZE); ix++)
+		{
+			priv_sprite[ix] = FALLBACK_COLOR;
+		}
+	}
+}
+
+
+static void spawn(const Wave_T * wave)
+{
+	const Path_T * path = &priv_paths[wave->path];
+	uint16_t ix;
+
+	if (priv_count >= MAX_ENEMIES)
+	{
+		return;
+	}
+
+	ix = priv_count++;
+
+	/* One step before the start, the update moves it onto the first entry. */
+	priv_pos[ix] = path->start - 1u;
+	priv_end[ix] = path->start + path->length;
+	priv_off_x[ix] = wave->dx;
+	priv_off_y[ix] = wave->dy;
+}
@@ -0,0 +1,54 @@
+/*
+ * waves.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Scripted enemy waves. The script on the SD card defines motion paths and the waves that
+ *  follow them. Every path is turned into a table of fixed point positions when the script is
+ *  loaded, so moving an enemy is one increment of its table index and drawing it is one lookup.
+ */
+
+#ifndef MAIN_WAVES_H_
+#define MAIN_WAVES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdkconfig.h"
+#include "memPool.h"
+
+/* Path tables are in 1/16 pixel units. */
+#define WAVES_FP_SHIFT 4
+
+#define WAVES_ENEMY_SIZE 16
+
+/* Bitmap the sprite is scaled down from. */
+#define WAVES_GHOST_SIZE 64
+
+/* Path tables, the enemy pool and the sprite, all taken from the level arena, plus the ghost
+ * bitmap that is only held while the sprite is made. */
+#define WAVES_ARENA_SIZE	((CONFIG_WAVES_MAX_PATH_STEPS * 2u * sizeof(int16_t)) + \
+							 (CONFIG_WAVES_MAX_ENEMIES * 4u * sizeof(uint16_t)) + \
+							 (WAVES_ENEMY_SIZE * WAVES_ENEMY_SIZE * sizeof(uint16_t)) + \
+							 (WAVES_GHOST_SIZE * WAVES_GHOST_SIZE * sizeof(uint16_t)) + 80u)
+
+/* Reads the script and builds the path tables. Returns false if there is no usable script,
+ * the game then runs without waves. */
+extern bool waves_load(MemPoolArena_T * arena, const char * path);
+
+/* Spawns the waves that are due and moves all enemies one frame along their paths. */
+extern void waves_update(void);
+
+/* Draws the enemies on rows first_row ... end_row - 1, for banded rendering. */
+extern void waves_renderRows(uint16_t * frame_buf, int first_row, int end_row);
+
+/* Rows touched by the enemies after the last update. Returns false if there are none. */
+extern bool waves_getRows(int * first_row, int * last_row);
+
+/* Removes the enemy at the given point, if there is one. Returns true on a hit. */
+extern bool waves_hitTest(int xPos, int yPos);
+
+extern uint16_t waves_getCount(void);
+
+#endif /* MAIN_WAVES_H_ */
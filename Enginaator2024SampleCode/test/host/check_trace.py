@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+#
+# check_trace.py
+#
+#  Created on: 19 Oct 2026
+#      Author: Joonatan
+#
+# Converts the trace written by test_trace with tools/trace_to_chrome.py and checks the JSON:
+# both cores are there, on each core the timestamps do not go backwards, every end event closes
+# the innermost open scope of the same name, and render_band scopes are inside a frame scope.
+#
+# Usage: check_trace.py trace_to_chrome.py trace.txt trace.json
+
+import json
+import subprocess
+import sys
+
+EXPECTED_CORES = {0, 1}
+# Events per core that must survive the conversion, a good part of the ring buffer.
+MIN_EVENTS_PER_CORE = 2000
+
+
+def check(events):
+    errors = []
+    stacks = {}
+    last_ts = {}
+    counts = {}
+    frames_seen = set()
+
+    for event in events:
+        tid, name, phase, ts = event["tid"], event["name"], event["ph"], event["ts"]
+        stack = stacks.setdefault(tid, [])
+        counts[tid] = counts.get(tid, 0) + 1
+
+        if ts < last_ts.get(tid, ts):
+            errors.append("core %d : %s %s at %.3f is before the previous event at %.3f" % (tid, phase, name, ts, last_ts[tid]))
+        last_ts[tid] = ts
+
+        if phase == "B":
+            # The frame around the first bands of a core can be older than its ring buffer.
+            if name == "render_band" and "frame" not in stack and tid in frames_seen:
+                errors.append("core %d : render_band at %.3f outside of a frame" % (tid, ts))
+            if name == "frame":
+                frames_seen.add(tid)
+            stack.append(name)
+        elif phase == "E":
+            if not stack or stack[-1] != name:
+                errors.append("core %d : end of %s at %.3f does not close the innermost scope %s" % (tid, name, ts, stack[-1] if stack else None))
+            else:
+                stack.pop()
+        else:
+            errors.append("unexpected phase %s" % phase)
+
+    for tid, stack in stacks.items():
+        if stack:
+            errors.append("core %d : scopes %s never closed" % (tid, stack))
+
+    if set(counts) != EXPECTED_CORES:
+        errors.append("events from cores %s, expected %s" % (sorted(counts), sorted(EXPECTED_CORES)))
+
+    for tid, count in counts.items():
+        if count < MIN_EVENTS_PER_CORE:
+            errors.append("core %d : only %d events" % (tid, count))
+
+    return errors, counts
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit("usage: check_trace.py trace_to_chrome.py trace.txt trace.json")
+
+    subprocess.run([sys.executable, sys.argv[1], sys.argv[2], sys.argv[3]], check=True)
+
+    with open(sys.argv[3]) as f:
+        events = json.load(f)["traceEvents"]
+
+    errors, counts = check(events)
+
+    for error in errors[:20]:
+        print(error)
+
+    if errors:
+        sys.exit("trace : %d errors" % len(errors))
+
+    print("trace : %s events per core, scopes nested and in order" % ", ".join("%d" % counts[tid] for tid in sorted(counts)))
+
+
+if __name__ == "__main__":
+    main()
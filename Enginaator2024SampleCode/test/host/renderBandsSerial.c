@@ -0,0 +1,18 @@
+/*
+ * renderBandsSerial.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+
+#undef CONFIG_RENDER_PARALLEL
+
+#define renderBands_init		renderBandsSerial_init
+#define renderBands_begin		renderBandsSerial_begin
+#define renderBands_fillRect	renderBandsSerial_fillRect
+#define renderBands_blitColumns	renderBandsSerial_blitColumns
+#define renderBands_callback	renderBandsSerial_callback
+#define renderBands_execute		renderBandsSerial_execute
+
+#include "renderBandsSerial.h"
+#include "renderBands.c"
@@ -0,0 +1,23 @@
+/*
+ * renderBandsSerial.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  main/renderBands.c built a second time without CONFIG_RENDER_PARALLEL, under other names, so the
+ *  test can run the parallel and the serial renderer side by side in one process.
+ */
+
+#ifndef HOST_RENDERBANDSSERIAL_H_
+#define HOST_RENDERBANDSSERIAL_H_
+
+#include "renderBands.h"
+
+extern void renderBandsSerial_init(void);
+extern void renderBandsSerial_begin(uint16_t * frame_buf);
+extern void renderBandsSerial_fillRect(int xPos, int yPos, int width, int height, uint16_t color);
+extern void renderBandsSerial_blitColumns(int xPos, int yPos, int width, int height, const uint16_t * data);
+extern void renderBandsSerial_callback(int yPos, int height, RenderBandsCallback_T callback);
+extern void renderBandsSerial_execute(void);
+
+#endif /* HOST_RENDERBANDSSERIAL_H_ */
@@ -0,0 +1,18 @@
+/*
+ * esp_cpu.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  CPU cycle counter on the host. It counts nanoseconds of the monotonic clock and wraps at 32 bits,
+ *  after about 4 seconds, so code that reads it sees the same wraparound as on the target.
+ */
+
+#ifndef HOST_ESP_CPU_H_
+#define HOST_ESP_CPU_H_
+
+#include <stdint.h>
+
+extern uint32_t esp_cpu_get_cycle_count(void);
+
+#endif /* HOST_ESP_CPU_H_ */
@@ -0,0 +1,26 @@
+/*
+ * esp_err.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  The part of the ESP-IDF error codes that the host build needs.
+ */
+
+#ifndef HOST_ESP_ERR_H_
+#define HOST_ESP_ERR_H_
+
+#include <stdint.h>
+#include <assert.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK					0
+#define ESP_FAIL				(-1)
+#define ESP_ERR_INVALID_ARG		0x102
+#define ESP_ERR_INVALID_SIZE	0x104
+#define ESP_ERR_NOT_FOUND		0x105
+
+#define ESP_ERROR_CHECK(x)		do { esp_err_t err_rc_ = (x); assert(err_rc_ == ESP_OK); (void)err_rc_; } while(0)
+
+#endif /* HOST_ESP_ERR_H_ */
@@ -0,0 +1,26 @@
+/*
+ * esp_heap_caps.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  The host has one heap. The capabilities are accepted and ignored, and the heap statistics read 0.
+ */
+
+#ifndef HOST_ESP_HEAP_CAPS_H_
+#define HOST_ESP_HEAP_CAPS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MALLOC_CAP_8BIT			(1u << 2)
+#define MALLOC_CAP_DMA			(1u << 3)
+#define MALLOC_CAP_SPIRAM		(1u << 10)
+#define MALLOC_CAP_INTERNAL		(1u << 11)
+
+extern void * heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps);
+extern size_t heap_caps_get_free_size(uint32_t caps);
+extern size_t heap_caps_get_largest_free_block(uint32_t caps);
+extern size_t heap_caps_get_minimum_free_size(uint32_t caps);
+
+#endif /* HOST_ESP_HEAP_CAPS_H_ */
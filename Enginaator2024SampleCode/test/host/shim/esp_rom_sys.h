@@ -0,0 +1,16 @@
+/*
+ * esp_rom_sys.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+
+#ifndef HOST_ESP_ROM_SYS_H_
+#define HOST_ESP_ROM_SYS_H_
+
+#include <stdint.h>
+
+/* Rate of esp_cpu_get_cycle_count, one tick per nanosecond on the host. */
+extern uint32_t esp_rom_get_cpu_ticks_per_us(void);
+
+#endif /* HOST_ESP_ROM_SYS_H_ */
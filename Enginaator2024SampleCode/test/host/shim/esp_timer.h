@@ -0,0 +1,33 @@
+/*
+ * esp_timer.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+
+#ifndef HOST_ESP_TIMER_H_
+#define HOST_ESP_TIMER_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef void (*esp_timer_cb_t)(void * arg);
+
+typedef struct
+{
+	esp_timer_cb_t callback;
+	void * arg;
+	const char * name;
+} esp_timer_create_args_t;
+
+typedef struct HostTimer * esp_timer_handle_t;
+
+/* Microseconds from the monotonic clock. */
+extern int64_t esp_timer_get_time(void);
+
+/* Periodic timers only. Each one is a thread that calls the callback on a fixed time grid. */
+extern esp_err_t esp_timer_create(const esp_timer_create_args_t * args, esp_timer_handle_t * handle);
+extern esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us);
+
+#endif /* HOST_ESP_TIMER_H_ */
@@ -0,0 +1,62 @@
+/*
+ * FreeRTOS.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Just enough of the FreeRTOS API to run the game modules on a PC. Tasks are threads, and
+ *  notifications, semaphores and queues are built on a mutex and a condition variable each.
+ *  Priorities are ignored, the host scheduler decides. A pinned task reports its core from
+ *  xPortGetCoreID, everything else runs on core 0. Critical sections are a mutex. See hostRtos.c.
+ */
+
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "sdkconfig.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define configTICK_RATE_HZ		1000u
+#define portTICK_PERIOD_MS		(1000u / configTICK_RATE_HZ)
+#define portMAX_DELAY			0xffffffffu
+#define pdMS_TO_TICKS(ms)		((TickType_t)(ms) / portTICK_PERIOD_MS)
+
+#define pdFALSE					0
+#define pdTRUE					1
+#define pdFAIL					0
+#define pdPASS					1
+
+#define tskIDLE_PRIORITY		0u
+#define portNUM_PROCESSORS		2
+
+#define IRAM_ATTR
+
+typedef struct
+{
+	pthread_mutex_t lock;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED	{ PTHREAD_MUTEX_INITIALIZER }
+
+#define portENTER_CRITICAL(mux)			pthread_mutex_lock(&(mux)->lock)
+#define portEXIT_CRITICAL(mux)			pthread_mutex_unlock(&(mux)->lock)
+#define portENTER_CRITICAL_ISR(mux)		portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)		portEXIT_CRITICAL(mux)
+#define portENTER_CRITICAL_SAFE(mux)	portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_SAFE(mux)		portEXIT_CRITICAL(mux)
+
+extern BaseType_t xPortGetCoreID(void);
+
+/* Interrupts are plain threads on the host, there is nothing to switch to. */
+#define portYIELD_FROM_ISR(woken)		((void)(woken))
+
+#endif /* HOST_FREERTOS_H_ */
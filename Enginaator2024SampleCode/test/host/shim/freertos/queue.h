@@ -0,0 +1,20 @@
+/*
+ * queue.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+
+#ifndef HOST_QUEUE_H_
+#define HOST_QUEUE_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct HostQueue * QueueHandle_t;
+
+extern QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+extern BaseType_t xQueueSend(QueueHandle_t queue, const void * item, TickType_t ticks);
+extern BaseType_t xQueueReceive(QueueHandle_t queue, void * item, TickType_t ticks);
+extern BaseType_t xQueueReset(QueueHandle_t queue);
+
+#endif /* HOST_QUEUE_H_ */
@@ -0,0 +1,23 @@
+/*
+ * semphr.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+
+#ifndef HOST_SEMPHR_H_
+#define HOST_SEMPHR_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct HostSemaphore * SemaphoreHandle_t;
+
+extern SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+extern SemaphoreHandle_t xSemaphoreCreateMutex(void);
+extern BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+extern BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+#define xSemaphoreCreateBinary()					xSemaphoreCreateCounting(1u, 0u)
+#define xSemaphoreGiveFromISR(sem, woken)			(*(woken) = pdFALSE, xSemaphoreGive(sem))
+
+#endif /* HOST_SEMPHR_H_ */
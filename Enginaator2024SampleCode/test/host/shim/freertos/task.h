@@ -0,0 +1,27 @@
+/*
+ * task.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ */
+
+#ifndef HOST_TASK_H_
+#define HOST_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct HostTask * TaskHandle_t;
+typedef void (*TaskFunction_t)(void * param);
+
+extern BaseType_t xTaskCreate(TaskFunction_t task, const char * name, uint32_t stack_size, void * param, UBaseType_t priority, TaskHandle_t * handle);
+extern BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char * name, uint32_t stack_size, void * param, UBaseType_t priority, TaskHandle_t * handle, BaseType_t core);
+extern void vTaskDelete(TaskHandle_t task);
+
+extern void vTaskDelay(TickType_t ticks);
+extern void vTaskDelayUntil(TickType_t * previous_wake, TickType_t period);
+extern TickType_t xTaskGetTickCount(void);
+
+extern void xTaskNotifyGive(TaskHandle_t task);
+extern uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#endif /* HOST_TASK_H_ */
@@ -0,0 +1,544 @@
+/*
+ * hostRtos.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  FreeRTOS and esp_timer on top of POSIX threads, for the host build.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_heap_caps.h"
+
+/****************** Private type definitions *******************/
+
+struct HostTask
+{
+	pthread_t thread;
+	TaskFunction_t function;
+	void * param;
+
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint32_t notify_count;
+	BaseType_t core;
+};
+
+struct HostTimer
+{
+	pthread_t thread;
+	esp_timer_cb_t callback;
+	void * arg;
+	uint64_t period_us;
+};
+
+struct HostSemaphore
+{
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	UBaseType_t count;
+	UBaseType_t max_count;
+};
+
+struct HostQueue
+{
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint8_t * items;
+	UBaseType_t length;
+	UBaseType_t item_size;
+	UBaseType_t head;
+	UBaseType_t count;
+};
+
+/**************** Private function forward declarations **************/
+
+static BaseType_t priv_createTask(TaskFunction_t task, void * param, BaseType_t core, TaskHandle_t * handle);
+static void * priv_taskEntry(void * param);
+static void * priv_timerEntry(void * param);
+static struct HostTask * priv_currentTask(void);
+static bool priv_wait(pthread_cond_t * cond, pthread_mutex_t * lock, const struct timespec * deadline);
+static void priv_deadline(TickType_t ticks, struct timespec * deadline);
+
+/**************** Private variable declarations ******************/
+
+/* The task that runs on each thread. Threads not created by xTaskCreate (main) get one on first use. */
+static __thread struct HostTask * priv_current_task = NULL;
+
+/**************** Public functions  **************/
+
+int64_t esp_timer_get_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((int64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t * args, esp_timer_handle_t * handle)
+{
+	struct HostTimer * timer = calloc(1u, sizeof(struct HostTimer));
+
+	if (timer == NULL)
+	{
+		return ESP_FAIL;
+	}
+
+	timer->callback = args->callback;
+	timer->arg = args->arg;
+	*handle = timer;
+
+	return ESP_OK;
+}
+
+
+/* The timer runs until the program ends. */
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+	timer->period_us = period_us;
+
+	if (pthread_create(&timer->thread, NULL, priv_timerEntry, timer) != 0)
+	{
+		return ESP_FAIL;
+	}
+
+	pthread_detach(timer->thread);
+	return ESP_OK;
+}
+
+
+uint32_t esp_cpu_get_cycle_count(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)(((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec);
+}
+
+
+uint32_t esp_rom_get_cpu_ticks_per_us(void)
+{
+	return 1000u;
+}
+
+
+void * heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+	void * res = NULL;
+
+	(void)caps;
+
+	if (posix_memalign(&res, alignment, size) != 0)
+	{
+		return NULL;
+	}
+
+	return res;
+}
+
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+	return 0u;
+}
+
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+	return 0u;
+}
+
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+	return 0u;
+}
+
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char * name, uint32_t stack_size, void * param, UBaseType_t priority, TaskHandle_t * handle)
+{
+	return priv_createTask(task, param, 0, handle);
+}
+
+
+/* The core is only remembered for xPortGetCoreID, the thread can run anywhere. */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char * name, uint32_t stack_size, void * param, UBaseType_t priority, TaskHandle_t * handle, BaseType_t core)
+{
+	return priv_createTask(task, param, core, handle);
+}
+
+
+BaseType_t xPortGetCoreID(void)
+{
+	return (priv_current_task != NULL) ? priv_current_task->core : 0;
+}
+
+
+/* Only deleting the calling task is supported, which is all the game modules do. */
+void vTaskDelete(TaskHandle_t task)
+{
+	struct HostTask * t = priv_current_task;
+
+	assert((task == NULL) || (task == t));
+
+	if (t != NULL)
+	{
+		pthread_mutex_destroy(&t->lock);
+		pthread_cond_destroy(&t->cond);
+		free(t);
+		priv_current_task = NULL;
+	}
+
+	pthread_exit(NULL);
+}
+
+
+void vTaskDelay(TickType_t ticks)
+{
+	struct timespec delay;
+	uint64_t delay_us = (uint64_t)ticks * portTICK_PERIOD_MS * 1000u;
+
+	delay.tv_sec = (time_t)(delay_us / 1000000u);
+	delay.tv_nsec = (long)((delay_us % 1000000u) * 1000u);
+
+	while ((nanosleep(&delay, &delay) != 0) && (errno == EINTR))
+	{
+	}
+}
+
+
+void vTaskDelayUntil(TickType_t * previous_wake, TickType_t period)
+{
+	TickType_t now = xTaskGetTickCount();
+
+	*previous_wake += period;
+
+	if ((int32_t)(*previous_wake - now) > 0)
+	{
+		vTaskDelay(*previous_wake - now);
+	}
+}
+
+
+TickType_t xTaskGetTickCount(void)
+{
+	return (TickType_t)(esp_timer_get_time() / (portTICK_PERIOD_MS * 1000));
+}
+
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+	pthread_mutex_lock(&task->lock);
+	task->notify_count++;
+	pthread_cond_signal(&task->cond);
+	pthread_mutex_unlock(&task->lock);
+}
+
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+	struct HostTask * t = priv_currentTask();
+	struct timespec deadline;
+	uint32_t count;
+
+	priv_deadline(ticks, &deadline);
+
+	pthread_mutex_lock(&t->lock);
+
+	while ((t->notify_count == 0u) && priv_wait(&t->cond, &t->lock, (ticks == portMAX_DELAY) ? NULL : &deadline))
+	{
+	}
+
+	count = t->notify_count;
+	if (count > 0u)
+	{
+		t->notify_count = clear_on_exit ? 0u : (count - 1u);
+	}
+
+	pthread_mutex_unlock(&t->lock);
+	return count;
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+	struct HostSemaphore * sem = calloc(1u, sizeof(struct HostSemaphore));
+
+	if (sem != NULL)
+	{
+		pthread_mutex_init(&sem->lock, NULL);
+		pthread_cond_init(&sem->cond, NULL);
+		sem->count = initial_count;
+		sem->max_count = max_count;
+	}
+
+	return sem;
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+	return xSemaphoreCreateCounting(1u, 1u);
+}
+
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+	struct timespec deadline;
+	BaseType_t res = pdFALSE;
+
+	priv_deadline(ticks, &deadline);
+
+	pthread_mutex_lock(&sem->lock);
+
+	while ((sem->count == 0u) && priv_wait(&sem->cond, &sem->lock, (ticks == portMAX_DELAY) ? NULL : &deadline))
+	{
+	}
+
+	if (sem->count > 0u)
+	{
+		sem->count--;
+		res = pdTRUE;
+	}
+
+	pthread_mutex_unlock(&sem->lock);
+	return res;
+}
+
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+	BaseType_t res = pdFALSE;
+
+	pthread_mutex_lock(&sem->lock);
+
+	if (sem->count < sem->max_count)
+	{
+		sem->count++;
+		pthread_cond_signal(&sem->cond);
+		res = pdTRUE;
+	}
+
+	pthread_mutex_unlock(&sem->lock);
+	return res;
+}
+
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+	struct HostQueue * queue = calloc(1u, sizeof(struct HostQueue));
+
+	if (queue != NULL)
+	{
+		queue->items = calloc(length, item_size);
+		if (queue->items == NULL)
+		{
+			free(queue);
+			return NULL;
+		}
+
+		pthread_mutex_init(&queue->lock, NULL);
+		pthread_cond_init(&queue->cond, NULL);
+		queue->length = length;
+		queue->item_size = item_size;
+	}
+
+	return queue;
+}
+
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void * item, TickType_t ticks)
+{
+	struct timespec deadline;
+	BaseType_t res = pdFALSE;
+
+	priv_deadline(ticks, &deadline);
+
+	pthread_mutex_lock(&queue->lock);
+
+	while ((queue->count == queue->length) && (ticks > 0u) && priv_wait(&queue->cond, &queue->lock, (ticks == portMAX_DELAY) ? NULL : &deadline))
+	{
+	}
+
+	if (queue->count < queue->length)
+	{
+		memcpy(queue->items + (((queue->head + queue->count) % queue->length) * queue->item_size), item, queue->item_size);
+		queue->count++;
+		pthread_cond_broadcast(&queue->cond);
+		res = pdTRUE;
+	}
+
+	pthread_mutex_unlock(&queue->lock);
+	return res;
+}
+
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void * item, TickType_t ticks)
+{
+	struct timespec deadline;
+	BaseType_t res = pdFALSE;
+
+	priv_deadline(ticks, &deadline);
+
+	pthread_mutex_lock(&queue->lock);
+
+	while ((queue->count == 0u) && (ticks > 0u) && priv_wait(&queue->cond, &queue->lock, (ticks == portMAX_DELAY) ? NULL : &deadline))
+	{
+	}
+
+	if (queue->count > 0u)
+	{
+		memcpy(item, queue->items + (queue->head * queue->item_size), queue->item_size);
+		queue->head = (queue->head + 1u) % queue->length;
+		queue->count--;
+		pthread_cond_broadcast(&queue->cond);
+		res = pdTRUE;
+	}
+
+	pthread_mutex_unlock(&queue->lock);
+	return res;
+}
+
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+	pthread_mutex_lock(&queue->lock);
+	queue->head = 0u;
+	queue->count = 0u;
+	pthread_cond_broadcast(&queue->cond);
+	pthread_mutex_unlock(&queue->lock);
+
+	return pdPASS;
+}
+
+/*********** Private functions ***********/
+
+static BaseType_t priv_createTask(TaskFunction_t task, void * param, BaseType_t core, TaskHandle_t * handle)
+{
+	struct HostTask * t = calloc(1u, sizeof(struct HostTask));
+	pthread_t thread;
+
+	if (t == NULL)
+	{
+		return pdFAIL;
+	}
+
+	t->function = task;
+	t->param = param;
+	t->core = core;
+	pthread_mutex_init(&t->lock, NULL);
+	pthread_cond_init(&t->cond, NULL);
+
+	if (handle != NULL)
+	{
+		*handle = t;
+	}
+
+	/* The task may delete itself before pthread_create returns, so t is not touched after it. */
+	if (pthread_create(&thread, NULL, priv_taskEntry, t) != 0)
+	{
+		free(t);
+		return pdFAIL;
+	}
+
+	pthread_detach(thread);
+	return pdPASS;
+}
+
+
+static void * priv_taskEntry(void * param)
+{
+	struct HostTask * t = (struct HostTask *)param;
+
+	t->thread = pthread_self();
+	priv_current_task = t;
+	t->function(t->param);
+
+	/* A FreeRTOS task must not return, it deletes itself. */
+	assert(false);
+	return NULL;
+}
+
+
+/* Deadlines are on a fixed grid from the start, so the period does not drift with the wakeup latency. */
+static void * priv_timerEntry(void * param)
+{
+	struct HostTimer * timer = (struct HostTimer *)param;
+	struct timespec deadline;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+	while(1)
+	{
+		deadline.tv_nsec += (long)(timer->period_us * 1000u);
+		while (deadline.tv_nsec >= 1000000000L)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+		{
+		}
+
+		timer->callback(timer->arg);
+	}
+
+	return NULL;
+}
+
+
+static struct HostTask * priv_currentTask(void)
+{
+	if (priv_current_task == NULL)
+	{
+		priv_current_task = calloc(1u, sizeof(struct HostTask));
+		assert(priv_current_task);
+		priv_current_task->thread = pthread_self();
+		pthread_mutex_init(&priv_current_task->lock, NULL);
+		pthread_cond_init(&priv_current_task->cond, NULL);
+	}
+
+	return priv_current_task;
+}
+
+
+/* Returns false once the deadline has passed. No deadline waits for ever. */
+static bool priv_wait(pthread_cond_t * cond, pthread_mutex_t * lock, const struct timespec * deadline)
+{
+	if (deadline == NULL)
+	{
+		pthread_cond_wait(cond, lock);
+		return true;
+	}
+
+	return (pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT);
+}
+
+
+static void priv_deadline(TickType_t ticks, struct timespec * deadline)
+{
+	uint64_t wait_us = (ticks == portMAX_DELAY) ? 0u : ((uint64_t)ticks * portTICK_PERIOD_MS * 1000u);
+
+	clock_gettime(CLOCK_REALTIME, deadline);
+	deadline->tv_sec += (time_t)(wait_us / 1000000u);
+	deadline->tv_nsec += (long)((wait_us % 1000000u) * 1000u);
+
+	if (deadline->tv_nsec >= 1000000000L)
+	{
+		deadline->tv_sec++;
+		deadline->tv_nsec -= 1000000000L;
+	}
+}
@@ -0,0 +1,18 @@
+/*
+ * sdkconfig.h
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Configuration for the host build. Same as the defaults of main/Kconfig.projbuild, except that
+ *  each test turns on the options it needs on the compiler command line.
+ */
+
+#ifndef HOST_SDKCONFIG_H_
+#define HOST_SDKCONFIG_H_
+
+#define CONFIG_DISPLAY_PANEL_ST7789_240X320 1
+#define CONFIG_DISPLAY_ROTATION_90 1
+#define CONFIG_TARGET_FPS 25
+
+#endif /* HOST_SDKCONFIG_H_ */
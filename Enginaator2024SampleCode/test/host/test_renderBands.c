@@ -0,0 +1,316 @@
+/*
+ * test_renderBands.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Renders random scenes with the parallel banded renderer, the serial one and a plain reference
+ *  rasterizer that draws every command over the whole screen in order, and checks that all three
+ *  give the same frame. Then times a game-like frame with the parallel and the serial renderer.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_timer.h"
+
+#include "renderBands.h"
+#include "renderBandsSerial.h"
+#include "display.h"
+
+/****************** Private defines *******************/
+
+/* Signed, so they can be compared with positions that are off screen. */
+#define SCREEN_WIDTH		((int)DISPLAY_WIDTH)
+#define SCREEN_HEIGHT		((int)DISPLAY_HEIGHT)
+#define FRAME_PIXELS		(SCREEN_WIDTH * SCREEN_HEIGHT)
+#define MAX_SCENE_COMMANDS	120
+#define RANDOM_SCENES		500
+
+#define SPRITE_WIDTH		53
+#define SPRITE_HEIGHT		40
+
+#define BENCHMARK_FRAMES	2000
+#define BENCHMARK_STARS		100
+#define BENCHMARK_LAYERS	6
+
+/****************** Private type definitions *******************/
+
+typedef enum
+{
+	CMD_FILL,
+	CMD_BLIT,
+	CMD_CALLBACK,
+} CommandType_T;
+
+typedef struct
+{
+	CommandType_T type;
+	int x;
+	int y;
+	int width;
+	int height;
+	uint16_t color;
+} SceneCommand_T;
+
+/**************** Private variable declarations ******************/
+
+static uint16_t priv_parallel[FRAME_PIXELS];
+static uint16_t priv_serial[FRAME_PIXELS];
+static uint16_t priv_reference[FRAME_PIXELS];
+
+/* Column by column, as renderBands_blitColumns expects. */
+static uint16_t priv_sprite[SPRITE_WIDTH * SPRITE_HEIGHT];
+
+static SceneCommand_T priv_scene[MAX_SCENE_COMMANDS];
+static int priv_scene_length;
+
+/**************** Private functions ******************/
+
+/* Draws every other pixel, like the enemies of the waves module leave the background showing through. */
+static void priv_callbackRows(uint16_t * frame_buf, int first_row, int end_row)
+{
+	for (int y = first_row; y < end_row; y++)
+	{
+		for (int x = (y & 1); x < SCREEN_WIDTH; x += 2)
+		{
+			frame_buf[(y * SCREEN_WIDTH) + x] = (uint16_t)((x * 31) ^ (y * 7));
+		}
+	}
+}
+
+
+static void priv_referenceRender(uint16_t * frame_buf)
+{
+	for (int ix = 0; ix < priv_scene_length; ix++)
+	{
+		const SceneCommand_T * cmd = &priv_scene[ix];
+
+		if (cmd->type == CMD_CALLBACK)
+		{
+			int y0 = MAX(cmd->y, 0);
+			int y1 = MIN(cmd->y + cmd->height, SCREEN_HEIGHT);
+
+			if (y1 > y0)
+			{
+				priv_callbackRows(frame_buf, y0, y1);
+			}
+			continue;
+		}
+
+		for (int y = MAX(cmd->y, 0); y < MIN(cmd->y + cmd->height, SCREEN_HEIGHT); y++)
+		{
+			for (int x = MAX(cmd->x, 0); x < MIN(cmd->x + cmd->width, SCREEN_WIDTH); x++)
+			{
+				frame_buf[(y * SCREEN_WIDTH) + x] = (cmd->type == CMD_FILL) ? cmd->color :
+						priv_sprite[((x - cmd->x) * SPRITE_HEIGHT) + (y - cmd->y)];
+			}
+		}
+	}
+}
+
+
+static void priv_submitParallel(void)
+{
+	for (int ix = 0; ix < priv_scene_length; ix++)
+	{
+		const SceneCommand_T * cmd = &priv_scene[ix];
+
+		switch(cmd->type)
+		{
+		case CMD_FILL:
+			renderBands_fillRect(cmd->x, cmd->y, cmd->width, cmd->height, cmd->color);
+			break;
+		case CMD_BLIT:
+			renderBands_blitColumns(cmd->x, cmd->y, cmd->width, cmd->height, priv_sprite);
+			break;
+		case CMD_CALLBACK:
+			renderBands_callback(cmd->y, cmd->height, priv_callbackRows);
+			break;
+		}
+	}
+}
+
+
+static void priv_submitSerial(void)
+{
+	for (int ix = 0; ix < priv_scene_length; ix++)
+	{
+		const SceneCommand_T * cmd = &priv_scene[ix];
+
+		switch(cmd->type)
+		{
+		case CMD_FILL:
+			renderBandsSerial_fillRect(cmd->x, cmd->y, cmd->width, cmd->height, cmd->color);
+			break;
+		case CMD_BLIT:
+			renderBandsSerial_blitColumns(cmd->x, cmd->y, cmd->width, cmd->height, priv_sprite);
+			break;
+		case CMD_CALLBACK:
+			renderBandsSerial_callback(cmd->y, cmd->height, priv_callbackRows);
+			break;
+		}
+	}
+}
+
+
+static void priv_renderBoth(void)
+{
+	renderBands_begin(priv_parallel);
+	priv_submitParallel();
+	renderBands_execute();
+
+	renderBandsSerial_begin(priv_serial);
+	priv_submitSerial();
+	renderBandsSerial_execute();
+}
+
+
+static void priv_addCommand(CommandType_T type, int x, int y, int width, int height, uint16_t color)
+{
+	SceneCommand_T * cmd = &priv_scene[priv_scene_length++];
+
+	cmd->type = type;
+	cmd->x = x;
+	cmd->y = y;
+	cmd->width = width;
+	cmd->height = height;
+	cmd->color = color;
+}
+
+
+/* Random rectangles, sprites and callbacks, some of them partly or completely off screen. */
+static void priv_randomScene(void)
+{
+	int count = 1 + (rand() % MAX_SCENE_COMMANDS);
+	int x, y;
+
+	priv_scene_length = 0;
+
+	for (int ix = 0; ix < count; ix++)
+	{
+		x = (rand() % (SCREEN_WIDTH + 80)) - 40;
+		y = (rand() % (SCREEN_HEIGHT + 80)) - 40;
+
+		switch(rand() % 8)
+		{
+		case 0:
+			priv_addCommand(CMD_BLIT, x, y, SPRITE_WIDTH, SPRITE_HEIGHT, 0u);
+			break;
+		case 1:
+			priv_addCommand(CMD_CALLBACK, 0, y, SCREEN_WIDTH, 1 + (rand() % 40), 0u);
+			break;
+		default:
+			priv_addCommand(CMD_FILL, x, y, rand() % 120, rand() % 120, (uint16_t)rand());
+			break;
+		}
+	}
+}
+
+
+/* Background, stars, the ship and the enemies, with the background repeated to get a few full screen layers of work. */
+static void priv_gameScene(void)
+{
+	priv_scene_length = 0;
+
+	for (int layer = 0; layer < BENCHMARK_LAYERS; layer++)
+	{
+		priv_addCommand(CMD_FILL, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, (uint16_t)(0x1000u * layer));
+	}
+
+	for (int ix = 0; ix < BENCHMARK_STARS; ix++)
+	{
+		priv_addCommand(CMD_FILL, (ix * 37) % SCREEN_WIDTH, (ix * 53) % SCREEN_HEIGHT, 2, 2, COLOR_WHITE);
+	}
+
+	priv_addCommand(CMD_BLIT, SCREEN_WIDTH - 80, 90, SPRITE_WIDTH, SPRITE_HEIGHT, 0u);
+	priv_addCommand(CMD_CALLBACK, 0, 20, SCREEN_WIDTH, 200, 0u);
+}
+
+
+static int priv_compare(const char * name, const uint16_t * result)
+{
+	for (int ix = 0; ix < FRAME_PIXELS; ix++)
+	{
+		if (result[ix] != priv_reference[ix])
+		{
+			printf("%s : pixel (%d, %d) is %04x, expected %04x\n", name,
+					ix % SCREEN_WIDTH, ix / SCREEN_WIDTH, result[ix], priv_reference[ix]);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**************** Public functions ******************/
+
+int main(void)
+{
+	int errors = 0;
+	int64_t start_us;
+	int64_t parallel_us;
+	int64_t serial_us;
+
+	for (int ix = 0; ix < (SPRITE_WIDTH * SPRITE_HEIGHT); ix++)
+	{
+		priv_sprite[ix] = (uint16_t)(ix * 2654435761u >> 16);
+	}
+
+	renderBands_init();
+	renderBandsSerial_init();
+	srand(1);
+
+	for (int scene = 0; (scene < RANDOM_SCENES) && (errors == 0); scene++)
+	{
+		priv_randomScene();
+
+		memset(priv_reference, 0, sizeof(priv_reference));
+		memset(priv_parallel, 0, sizeof(priv_parallel));
+		memset(priv_serial, 0, sizeof(priv_serial));
+
+		priv_referenceRender(priv_reference);
+		priv_renderBoth();
+
+		errors += priv_compare("parallel", priv_parallel);
+		errors += priv_compare("serial", priv_serial);
+	}
+
+	if (errors > 0)
+	{
+		printf("renderBands : output differs from the reference\n");
+		return 1;
+	}
+
+	printf("renderBands : %d random scenes match the reference\n", RANDOM_SCENES);
+
+	priv_gameScene();
+
+	start_us = esp_timer_get_time();
+	for (int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+	{
+		renderBandsSerial_begin(priv_serial);
+		priv_submitSerial();
+		renderBandsSerial_execute();
+	}
+	serial_us = esp_timer_get_time() - start_us;
+
+	start_us = esp_timer_get_time();
+	for (int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+	{
+		renderBands_begin(priv_parallel);
+		priv_submitParallel();
+		renderBands_execute();
+	}
+	parallel_us = esp_timer_get_time() - start_us;
+
+	printf("renderBands : serial %lld us, parallel %lld us per frame, speedup %.2f with %d bands\n",
+			(long long)(serial_us / BENCHMARK_FRAMES),
+			(long long)(parallel_us / BENCHMARK_FRAMES),
+			(double)serial_us / (double)parallel_us,
+			RENDER_NUMBER_OF_BANDS);
+
+	return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * test_teSync.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Runs the simulated TE and checks that the edges come once per refresh period, then checks the
+ *  scanout model with writes placed relative to a real edge : a write that starts at the edge and
+ *  fits in the period stays ahead of the scan, one that starts late or is lapped by the scan is
+ *  counted as a tear risk.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_timer.h"
+
+#include "teSync.h"
+
+/****************** Private defines *******************/
+
+#define SCAN_PERIOD_US		CONFIG_DISPLAY_SCAN_PERIOD_US
+#define MEASURED_EDGES		30
+
+/* The host scheduler is not real time, the average period only has to be close. */
+#define PERIOD_TOLERANCE_US	(SCAN_PERIOD_US / 20)
+
+/****************** Private type definitions *******************/
+
+typedef struct
+{
+	const char * name;
+	uint32_t start_pct;		/* Start of the write after the edge, in percent of the period */
+	uint32_t duration_pct;	/* Length of the write, in percent of the period */
+	bool isTear;
+} WriteCase_T;
+
+/**************** Private variable declarations ******************/
+
+static const WriteCase_T priv_cases[] =
+{
+	{ "starts at the edge, 80 % of the period", 	0u, 	80u, 	false },
+	{ "starts at the edge, 99 % of the period", 	0u, 	99u, 	false },
+	{ "starts at the edge, 30 % of the period", 	0u, 	30u, 	false },
+	{ "starts at 30 %, 60 % of the period", 		30u, 	60u, 	true },
+	{ "starts at 5 %, 50 % of the period", 			5u, 	50u, 	true },
+	{ "starts at the edge, lapped by the scan", 	0u, 	300u, 	true },
+};
+
+#define NUMBER_OF_CASES (sizeof(priv_cases) / sizeof(priv_cases[0]))
+
+/**************** Private functions ******************/
+
+/* Waits for an edge and returns its time. With scan_lines equal to the period in microseconds
+ * the scan line is the time since the edge. */
+static int64_t priv_waitEdge(void)
+{
+	int64_t now_us;
+
+	if (!teSync_waitForTe())
+	{
+		return -1;
+	}
+
+	now_us = esp_timer_get_time();
+	return now_us - teSync_getScanLine(now_us, SCAN_PERIOD_US);
+}
+
+/**************** Public functions ******************/
+
+int main(void)
+{
+	TeSyncCounters_T counters;
+	int64_t first_edge_us, edge_us = -1;
+	int64_t start_us;
+	int64_t average_us;
+	uint32_t edges_before;
+	int errors = 0;
+
+	teSync_init();
+
+	first_edge_us = priv_waitEdge();
+	teSync_getCounters(&counters);
+	edges_before = counters.te_edges;
+
+	for (int ix = 0; ix < MEASURED_EDGES; ix++)
+	{
+		edge_us = priv_waitEdge();
+		if (edge_us < 0)
+		{
+			printf("teSync : no TE edge within two periods\n");
+			return 1;
+		}
+	}
+
+	teSync_getCounters(&counters);
+	average_us = (edge_us - first_edge_us) / MEASURED_EDGES;
+
+	if ((average_us < (SCAN_PERIOD_US - PERIOD_TOLERANCE_US)) || (average_us > (SCAN_PERIOD_US + PERIOD_TOLERANCE_US)) ||
+		((counters.te_edges - edges_before) < MEASURED_EDGES))
+	{
+		printf("teSync : %lu edges, average period %lld us, expected %d us\n",
+				(unsigned long)(counters.te_edges - edges_before), (long long)average_us, SCAN_PERIOD_US);
+		errors++;
+	}
+
+	/* Each write is checked right after its edge, before the next edge moves the reference. */
+	for (unsigned int ix = 0; ix < NUMBER_OF_CASES; ix++)
+	{
+		const WriteCase_T * wc = &priv_cases[ix];
+
+		edge_us = priv_waitEdge();
+		start_us = edge_us + ((SCAN_PERIOD_US * (int64_t)wc->start_pct) / 100);
+
+		if (teSync_checkWrite(start_us, start_us + ((SCAN_PERIOD_US * (int64_t)wc->duration_pct) / 100)) != wc->isTear)
+		{
+			printf("teSync : write that %s %s\n", wc->name, wc->isTear ? "was not counted as a tear" : "was counted as a tear");
+			errors++;
+		}
+	}
+
+	teSync_getCounters(&counters);
+
+	if ((counters.checked_writes != NUMBER_OF_CASES) || (counters.tear_risks != 3u))
+	{
+		printf("teSync : %lu writes checked, %lu tear risks\n", (unsigned long)counters.checked_writes, (unsigned long)counters.tear_risks);
+		errors++;
+	}
+
+	if (errors > 0)
+	{
+		printf("teSync : %d errors\n", errors);
+		return 1;
+	}
+
+	printf("teSync : average TE period %lld us, %u writes classified\n", (long long)average_us, (unsigned int)NUMBER_OF_CASES);
+	return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * test_trace.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Records nested trace scopes from two tasks pinned to different cores, long enough for the ring
+ *  buffers to wrap, and dumps the trace to the file given on the command line. check_trace.py then
+ *  converts it with tools/trace_to_chrome.py and checks the result.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "trace.h"
+
+/****************** Private defines *******************/
+
+/* Six events per frame, enough to wrap the rings of CONFIG_TRACE_BUFFER_EVENTS a few times. */
+#define FRAMES_PER_TASK		2000
+#define NUMBER_OF_TASKS		2
+#define BANDS_PER_FRAME		2
+
+/**************** Private variable declarations ******************/
+
+static SemaphoreHandle_t priv_done;
+static volatile uint32_t priv_work;
+
+/**************** Private functions ******************/
+
+static void priv_spin(int count)
+{
+	for (int ix = 0; ix < count; ix++)
+	{
+		priv_work += (uint32_t)ix;
+	}
+}
+
+
+static void priv_recordTask(void * param)
+{
+	for (int frame = 0; frame < FRAMES_PER_TASK; frame++)
+	{
+		TRACE_SCOPE("frame");
+		priv_spin(50);
+
+		for (int band = 0; band < BANDS_PER_FRAME; band++)
+		{
+			TRACE_SCOPE("render_band");
+			priv_spin(100);
+		}
+	}
+
+	xSemaphoreGive(priv_done);
+	vTaskDelete(NULL);
+}
+
+/**************** Public functions ******************/
+
+int main(int argc, char ** argv)
+{
+	FILE * f;
+
+	if (argc != 2)
+	{
+		printf("Usage: test_trace <trace output>\n");
+		return 1;
+	}
+
+	trace_init();
+	priv_done = xSemaphoreCreateCounting(NUMBER_OF_TASKS, 0u);
+
+	for (int core = 0; core < NUMBER_OF_TASKS; core++)
+	{
+		xTaskCreatePinnedToCore(priv_recordTask, "trace", 4096u, NULL, 1u, NULL, core);
+	}
+
+	for (int ix = 0; ix < NUMBER_OF_TASKS; ix++)
+	{
+		xSemaphoreTake(priv_done, portMAX_DELAY);
+	}
+
+	f = fopen(argv[1], "w");
+	if (f == NULL)
+	{
+		printf("Failed to open %s\n", argv[1]);
+		return 1;
+	}
+
+	trace_dump(f);
+	fclose(f);
+
+	printf("trace : %d frames on each of %d cores written to %s\n", FRAMES_PER_TASK, NUMBER_OF_TASKS, argv[1]);
+	return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * test_videoPlayer.c
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: Joonatan
+ *
+ *  Plays the demo animation of tools/make_video.py --demo twice. First into a sink that puts the
+ *  rectangles together into a frame, checking before every new frame that the picture so far is one
+ *  of the demo frames, later than the last one shown. Then into videoPlayer_standInSink, which takes
+ *  as long as the SPI transfer would, checking that the frame rate holds.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "videoPlayer.h"
+#include "display.h"
+
+/****************** Private defines *******************/
+
+#define FRAME_PIXELS		(DISPLAY_WIDTH * DISPLAY_HEIGHT)
+#define NUMBER_OF_SLOTS		2
+#define SQUARE_SIZE			32
+
+/* The stand-in must reach at least this share of the frame rate of the file. */
+#define MIN_FPS_PCT			95u
+
+/**************** Private variable declarations ******************/
+
+static uint16_t priv_screen[FRAME_PIXELS];
+static uint16_t priv_expected[FRAME_PIXELS];
+
+static int priv_next_frame = 0;
+static int priv_frames_matched = 0;
+static int priv_errors = 0;
+
+/**************** Private functions ******************/
+
+/* Same picture as demo_frames in tools/make_video.py. */
+static void priv_demoFrame(int ix, uint16_t * frame)
+{
+	int sx = (ix * 5) % (DISPLAY_WIDTH - SQUARE_SIZE);
+	int sy = ((DISPLAY_HEIGHT - SQUARE_SIZE) / 2) + ((ix * 3) % 40) - 20;
+
+	for (int y = 0; y < DISPLAY_HEIGHT; y++)
+	{
+		for (int x = 0; x < DISPLAY_WIDTH; x++)
+		{
+			uint32_t r = (x * 255u) / DISPLAY_WIDTH;
+			uint32_t g = (y * 255u) / DISPLAY_HEIGHT;
+			uint32_t b = 96u;
+
+			if ((x >= sx) && (x < (sx + SQUARE_SIZE)) && (y >= sy) && (y < (sy + SQUARE_SIZE)))
+			{
+				r = g = b = 255u;
+			}
+
+			frame[(y * DISPLAY_WIDTH) + x] = (uint16_t)CONVERT_888RGB_TO_565RGB(r, g, b);
+		}
+	}
+}
+
+
+static void checkSink_drawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t * pixels)
+{
+	for (int row = 0; row < height; row++)
+	{
+		memcpy(&priv_screen[((y + row) * DISPLAY_WIDTH) + x], &pixels[row * width], width * sizeof(uint16_t));
+	}
+}
+
+
+/* Called before every frame and at the end, so the screen then holds a complete frame. */
+static void checkSink_waitDone(void)
+{
+	/* Frames can be dropped, so look ahead for the one on the screen. */
+	for (int ix = priv_next_frame; ix < 1000; ix++)
+	{
+		priv_demoFrame(ix, priv_expected);
+
+		if (memcmp(priv_screen, priv_expected, sizeof(priv_screen)) == 0)
+		{
+			if ((ix > priv_next_frame) || (priv_frames_matched == 0))
+			{
+				priv_frames_matched++;
+			}
+
+			priv_next_frame = ix;
+			return;
+		}
+	}
+
+	/* The screen is still empty before the first frame. */
+	if (priv_frames_matched > 0)
+	{
+		printf("Screen does not match any demo frame after frame %d\n", priv_next_frame);
+		priv_errors++;
+	}
+}
+
+
+static const VideoSink_T priv_checkSink =
+{
+	.width = DISPLAY_WIDTH,
+	.height = DISPLAY_HEIGHT,
+	.drawRect = checkSink_drawRect,
+	.waitDone = checkSink_waitDone,
+};
+
+/**************** Public functions ******************/
+
+/* videoPlayer_displaySink refers to the display driver, which is not part of the host build. */
+void display_drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t * bmp_buf)
+{
+	abort();
+}
+
+
+void display_waitTransferDone(void)
+{
+	abort();
+}
+
+
+int main(int argc, char ** argv)
+{
+	uint8_t * slots[NUMBER_OF_SLOTS];
+	VideoStats_T stats;
+	uint32_t target_fps_x100;
+	esp_err_t res;
+
+	if (argc != 3)
+	{
+		printf("Usage: test_videoPlayer <video from make_video.py --demo> <frame rate>\n");
+		return 1;
+	}
+
+	target_fps_x100 = (uint32_t)atoi(argv[2]) * 100u;
+
+	for (int ix = 0; ix < NUMBER_OF_SLOTS; ix++)
+	{
+		slots[ix] = malloc(FRAME_PIXELS * sizeof(uint16_t));
+	}
+
+	memset(priv_screen, 0, sizeof(priv_screen));
+	res = videoPlayer_play(argv[1], slots, NUMBER_OF_SLOTS, FRAME_PIXELS * sizeof(uint16_t), &priv_checkSink, &stats);
+
+	if ((res != ESP_OK) || (stats.frames_total == 0u) || ((stats.frames_shown + stats.frames_dropped) != stats.frames_total) ||
+		(priv_frames_matched != (int)stats.frames_shown) || (priv_next_frame != (int)(stats.frames_total - 1u)))
+	{
+		printf("Check sink : play returned %d, %lu of %lu frames shown, %d of them on screen, %lu dropped, last frame on screen %d\n",
+				res, (unsigned long)stats.frames_shown, (unsigned long)stats.frames_total, priv_frames_matched, (unsigned long)stats.frames_dropped, priv_next_frame);
+		priv_errors++;
+	}
+
+	res = videoPlayer_play(argv[1], slots, NUMBER_OF_SLOTS, FRAME_PIXELS * sizeof(uint16_t), &videoPlayer_standInSink, &stats);
+
+	if ((res != ESP_OK) || ((stats.frames_shown + stats.frames_dropped) != stats.frames_total) ||
+		(stats.fps_x100 < ((target_fps_x100 * MIN_FPS_PCT) / 100u)))
+	{
+		printf("Stand-in sink : play returned %d, %lu.%02lu fps, %lu dropped\n",
+				res, (unsigned long)(stats.fps_x100 / 100u), (unsigned long)(stats.fps_x100 % 100u), (unsigned long)stats.frames_dropped);
+		priv_errors++;
+	}
+
+	for (int ix = 0; ix < NUMBER_OF_SLOTS; ix++)
+	{
+		free(slots[ix]);
+	}
+
+	if (priv_errors > 0)
+	{
+		printf("videoPlayer : %d errors\n", priv_errors);
+		return 1;
+	}
+
+	printf("videoPlayer : %d frames checked on screen, stand-in at %lu.%02lu fps\n", priv_frames_matched,
+			(unsigned long)(stats.fps_x100 / 100u), (unsigned long)(stats.fps_x100 % 100u));
+	return 0;
+}
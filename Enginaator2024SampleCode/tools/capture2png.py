@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+#
+# capture2png.py
+#
+#  Created on: 19 Oct 2026
+#      Author: Joonatan
+#
+# Converts frame captures from the SD card (see main/frameCapture.h) to PNG, and
+# optionally compares them with golden images. Each capture becomes tick_<tick>.png,
+# so captures of the same input replay can be compared run to run. A capture is
+# compared with the golden image of the same name. For every mismatch a diff image
+# is written next to the PNG, with the differing pixels in red over a dimmed copy
+# of the golden image. The exit code is 1 if any capture does not match.
+#
+# Usage: capture2png.py [-o out_dir] CAP00000.ECP ...
+#        capture2png.py --golden goldens/ [--tolerance 0] [-o out_dir] CAP*.ECP
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+CAPTURE_MAGIC = 0x50414345  # "ECAP"
+CAPTURE_VERSION = 1
+ENCODING_RLE16 = 1
+
+HEADER = struct.Struct("<IHHHHI")    # magic, version, width, height, encoding, tick
+RUN_FLAG = 0x8000
+
+PNG_SIGNATURE = b"\x89PNG\r\n\x1a\n"
+
+
+def display_to_rgb(pixel):
+    """Display format (byte swapped RGB565) to 8-bit RGB, the low bits filled by bit replication
+    like colorConv_565LineToBGR888 does."""
+    value = ((pixel & 0xFF) << 8) | (pixel >> 8)
+    r = (value >> 11) & 0x1F
+    g = (value >> 5) & 0x3F
+    b = value & 0x1F
+    return (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)
+
+
+def read_capture(path):
+    data = open(path, "rb").read()
+    magic, version, width, height, encoding, tick = HEADER.unpack_from(data, 0)
+    if magic != CAPTURE_MAGIC or version != CAPTURE_VERSION:
+        raise ValueError("%s is not a capture" % path)
+    if encoding != ENCODING_RLE16:
+        raise ValueError("%s : unknown encoding %d" % (path, encoding))
+
+    words = struct.unpack_from("<%dH" % ((len(data) - HEADER.size) // 2), data, HEADER.size)
+    pixels = []
+    ix = 0
+    while len(pixels) < width * height:
+        if ix >= len(words):
+            raise ValueError("%s is truncated" % path)
+        header = words[ix]
+        if header & RUN_FLAG:
+            pixels.extend([words[ix + 1]] * (header & ~RUN_FLAG))
+            ix += 2
+        else:
+            pixels.extend(words[ix + 1:ix + 1 + header])
+            ix += 1 + header
+
+    if len(pixels) != width * height:
+        raise ValueError("%s : pixel count does not match the size" % path)
+
+    rgb = bytearray()
+    for pixel in pixels:
+        rgb.extend(display_to_rgb(pixel))
+    return width, height, tick, bytes(rgb)
+
+
+def write_png(path, width, height, rgb):
+    def chunk(kind, payload):
+        return struct.pack(">I", len(payload)) + kind + payload + struct.pack(">I", zlib.crc32(kind + payload))
+
+    stride = width * 3
+    raw = b"".join(b"\x00" + rgb[y * stride:(y + 1) * stride] for y in range(height))
+
+    with open(path, "wb") as out:
+        out.write(PNG_SIGNATURE)
+        out.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)))
+        out.write(chunk(b"IDAT", zlib.compress(raw, 9)))
+        out.write(chunk(b"IEND", b""))
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(path):
+    """8-bit RGB or RGBA, not interlaced. Enough for the images this tool writes and for most editors."""
+    data = open(path, "rb").read()
+    if data[:8] != PNG_SIGNATURE:
+        raise ValueError("%s is not a PNG" % path)
+
+    pos = 8
+    idat = b""
+    while pos < len(data):
+        length, kind = struct.unpack_from(">I4s", data, pos)
+        payload = data[pos + 8:pos + 8 + length]
+        if kind == b"IHDR":
+            width, height, depth, color_type, _, _, interlace = struct.unpack(">IIBBBBB", payload)
+        elif kind == b"IDAT":
+            idat += payload
+        pos += 12 + length
+
+    if depth != 8 or color_type not in (2, 6) or interlace != 0:
+        raise ValueError("%s : only 8-bit RGB/RGBA PNGs without interlacing are supported" % path)
+
+    bpp = 3 if color_type == 2 else 4
+    stride = width * bpp
+    raw = zlib.decompress(idat)
+    prev = bytearray(stride)
+    rgb = bytearray()
+
+    for y in range(height):
+        filter_type = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for x in range(stride):
+            a = line[x - bpp] if x >= bpp else 0
+            b = prev[x]
+            c = prev[x - bpp] if x >= bpp else 0
+            if filter_type == 1:
+                line[x] = (line[x] + a) & 0xFF
+            elif filter_type == 2:
+                line[x] = (line[x] + b) & 0xFF
+            elif filter_type == 3:
+                line[x] = (line[x] + ((a + b) >> 1)) & 0xFF
+            elif filter_type == 4:
+                line[x] = (line[x] + paeth(a, b, c)) & 0xFF
+        for x in range(width):
+            rgb.extend(line[x * bpp:x * bpp + 3])
+        prev = line
+
+    return width, height, bytes(rgb)
+
+
+def compare(rgb, golden, tolerance):
+    """Returns the number of differing pixels, the largest channel difference and the diff image."""
+    diff = bytearray()
+    count = 0
+    worst = 0
+    for ix in range(0, len(rgb), 3):
+        delta = max(abs(rgb[ix + n] - golden[ix + n]) for n in range(3))
+        worst = max(worst, delta)
+        if delta > tolerance:
+            count += 1
+            diff.extend((255, 0, 0))
+        else:
+            diff.extend(value // 4 for value in golden[ix:ix + 3])
+    return count, worst, bytes(diff)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert frame captures to PNG and compare them with golden images.")
+    parser.add_argument("captures", nargs="+")
+    parser.add_argument("-o", "--out", default=".", help="output directory")
+    parser.add_argument("--golden", help="directory of golden tick_<tick>.png images")
+    parser.add_argument("--tolerance", type=int, default=0, help="largest allowed difference per color channel")
+    args = parser.parse_args()
+
+    os.makedirs(args.out, exist_ok=True)
+    failed = 0
+
+    for path in args.captures:
+        width, height, tick, rgb = read_capture(path)
+        name = "tick_%07d.png" % tick
+        write_png(os.path.join(args.out, name), width, height, rgb)
+
+        if not args.golden:
+            print("%s -> %s" % (path, name))
+            continue
+
+        golden_path = os.path.join(args.golden, name)
+        if not os.path.exists(golden_path):
+            print("%s : no golden image %s" % (path, name))
+            failed += 1
+            continue
+
+        g_width, g_height, golden = read_png(golden_path)
+        if (g_width, g_height) != (width, height):
+            print("%s : %dx%d, golden is %dx%d" % (path, width, height, g_width, g_height))
+            failed += 1
+            continue
+
+        count, worst, diff = compare(rgb, golden, args.tolerance)
+        if count:
+            diff_name = "tick_%07d_diff.png" % tick
+            write_png(os.path.join(args.out, diff_name), width, height, diff)
+            print("%s : %d pixels differ (up to %d), see %s" % (path, count, worst, diff_name))
+            failed += 1
+        else:
+            print("%s : matches %s" % (path, name))
+
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
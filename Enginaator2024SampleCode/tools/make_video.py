@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+#
+# make_video.py
+#
+#  Created on: 19 Oct 2026
+#      Author: Joonatan
+#
+# Builds a video for the firmware player (see main/videoPlayer.h) from a directory
+# of numbered .bmp frames. Every frame after a keyframe is stored as the rectangles
+# that changed since the previous frame. A keyframe is written every --keyint
+# frames, for the last frame, and whenever the changes would be larger than a whole
+# frame. The player skips to the next keyframe when it falls behind, so the last
+# frame is always shown.
+#
+# Usage: make_video.py [--fps 25] [--keyint 25] frames_dir intro.vid
+#        make_video.py --demo 100 demo.vid     (generated test animation)
+
+import argparse
+import os
+import struct
+import sys
+
+from pack_assets import bmp_to_rgb565, convert_888_to_565
+
+VIDEO_MAGIC = 0x44495645  # "EVID"
+VIDEO_VERSION = 1
+
+FRAME_KEY = 1
+FRAME_DELTA = 2
+
+HEADER = struct.Struct("<IHHHHHHII")   # magic, version, width, height, fps, keyframe interval, reserved, frame count, reserved
+FRAME = struct.Struct("<IBBH")         # payload size, type, reserved, rectangle count
+RECT = struct.Struct("<HHHH")          # x, y, width, height
+
+TILE = 16
+RECT_ALIGNMENT = 4
+
+
+def changed_rects(prev, curr, width, height):
+    """Rectangles of TILE x TILE tiles that differ. Runs of changed tiles in a tile row
+    become one rectangle, which is extended downwards while the next row has the same run."""
+    stride = width * 2
+    open_rects = {}
+    rects = []
+
+    for ty in range(0, height, TILE):
+        th = min(TILE, height - ty)
+        row_runs = []
+        run_start = None
+
+        for tx in range(0, width + TILE, TILE):
+            changed = False
+            if tx < width:
+                tw = min(TILE, width - tx)
+                for y in range(ty, ty + th):
+                    start = y * stride + tx * 2
+                    if prev[start:start + tw * 2] != curr[start:start + tw * 2]:
+                        changed = True
+                        break
+
+            if changed and run_start is None:
+                run_start = tx
+            elif not changed and run_start is not None:
+                row_runs.append((run_start, min(tx, width)))
+                run_start = None
+
+        next_open = {}
+        for x0, x1 in row_runs:
+            rect = open_rects.pop((x0, x1), None)
+            if rect is None:
+                rect = [x0, ty, x1 - x0, 0]
+                rects.append(rect)
+            rect[3] += th
+            next_open[(x0, x1)] = rect
+        open_rects = next_open
+
+    return rects
+
+
+def delta_payload(curr, width, rects):
+    stride = width * 2
+    out = bytearray()
+    for x, y, w, h in rects:
+        out += RECT.pack(x, y, w, h)
+        for row in range(y, y + h):
+            start = row * stride + x * 2
+            out += curr[start:start + w * 2]
+        out += bytes(-len(out) % RECT_ALIGNMENT)
+    return bytes(out)
+
+
+def demo_frames(count, width, height):
+    """A square moving over a gradient, so both keyframes and small deltas are exercised."""
+    background = bytearray()
+    for y in range(height):
+        for x in range(width):
+            background += struct.pack("<H", convert_888_to_565(x * 255 // width, y * 255 // height, 96))
+
+    square = struct.pack("<H", convert_888_to_565(255, 255, 255)) * 32
+    for ix in range(count):
+        frame = bytearray(background)
+        sx = (ix * 5) % (width - 32)
+        sy = (height - 32) // 2 + ((ix * 3) % 40) - 20
+        for y in range(sy, sy + 32):
+            start = (y * width + sx) * 2
+            frame[start:start + 64] = square
+        yield bytes(frame), width, height
+
+
+def bmp_frames(frames_dir):
+    names = sorted(n for n in os.listdir(frames_dir) if n.lower().endswith(".bmp"))
+    if not names:
+        sys.exit("no .bmp frames in %s" % frames_dir)
+    for name in names:
+        yield bmp_to_rgb565(open(os.path.join(frames_dir, name), "rb").read())
+
+
+def with_last_flag(frames):
+    """Yields (frame, is_last) pairs."""
+    prev = None
+    for frame in frames:
+        if prev is not None:
+            yield prev, False
+        prev = frame
+    if prev is not None:
+        yield prev, True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build a video for the firmware player.")
+    parser.add_argument("input", nargs="?", help="directory of .bmp frames, sorted by name")
+    parser.add_argument("output")
+    parser.add_argument("--fps", type=int, default=25)
+    parser.add_argument("--keyint", type=int, default=25, help="frames between keyframes")
+    parser.add_argument("--demo", type=int, metavar="FRAMES", help="generate a test animation instead")
+    args = parser.parse_args()
+
+    if args.demo:
+        frames = demo_frames(args.demo, 320, 240)
+    elif args.input:
+        frames = bmp_frames(args.input)
+    else:
+        parser.error("give a frames directory or --demo")
+
+    body = bytearray()
+    prev = None
+    since_key = 0
+    count = keys = 0
+    size = None
+
+    for (curr, width, height), is_last in with_last_flag(frames):
+        if size is None:
+            size = (width, height)
+        elif size != (width, height):
+            sys.exit("frame %d is %dx%d, expected %dx%d" % (count, width, height, size[0], size[1]))
+
+        payload = None
+        if prev is not None and since_key < args.keyint and not is_last:
+            rects = changed_rects(prev, curr, width, height)
+            payload = delta_payload(curr, width, rects)
+            if len(payload) >= len(curr):
+                payload = None
+
+        if payload is None:
+            body += FRAME.pack(len(curr), FRAME_KEY, 0, 0) + curr
+            since_key = 1
+            keys += 1
+        else:
+            body += FRAME.pack(len(payload), FRAME_DELTA, 0, len(rects)) + payload
+            since_key += 1
+
+        prev = curr
+        count += 1
+
+    with open(args.output, "wb") as out:
+        out.write(HEADER.pack(VIDEO_MAGIC, VIDEO_VERSION, size[0], size[1], args.fps, args.keyint, 0, count, 0))
+        out.write(body)
+
+    print("%d frames (%d keyframes), %d bytes, %d bytes per frame on average"
+          % (count, keys, HEADER.size + len(body), len(body) // max(count, 1)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+#
+# pack_assets.py
+#
+#  Created on: 19 Oct 2026
+#      Author: Joonatan
+#
+# Builds the asset pack that the firmware opens at boot (see main/assetPack.h).
+# Every .bmp in the input directory becomes one entry. By default the images are
+# converted to the display pixel format, so the firmware can read them straight
+# into a buffer without any conversion. Other files are stored as they are.
+#
+# Usage: pack_assets.py [--format rgb565|bmp] [--align 512] "SD Card" assets.pak
+
+import argparse
+import os
+import struct
+import sys
+
+PACK_MAGIC = 0x4B415045  # "EPAK"
+PACK_VERSION = 1
+
+FORMAT_RAW = 0
+FORMAT_BMP = 1
+FORMAT_RGB565 = 2
+
+NAME_LENGTH = 32
+HEADER = struct.Struct("<IHHI4x")        # magic, version, entry count, data start
+ENTRY = struct.Struct("<32sIIHHHH")      # name, offset, size, format, width, height, reserved
+
+
+def convert_888_to_565(r, g, b):
+    # Same as CONVERT_888RGB_TO_565RGB in display.h
+    return ((r >> 3) << 3) | (g >> 5) | (((g >> 2) & 0x7) << 13) | ((b >> 3) << 8)
+
+
+def read_bmp(data):
+    if data[0:2] != b"BM":
+        raise ValueError("not a bitmap")
+
+    offset, = struct.unpack_from("<I", data, 10)
+    width, height, planes, bpp, compression = struct.unpack_from("<iiHHI", data, 18)
+
+    if bpp not in (24, 32) or compression not in (0, 3):
+        raise ValueError("unsupported bitmap, %d bpp compression %d" % (bpp, compression))
+
+    return offset, width, height, bpp
+
+
+def bmp_to_rgb565(data):
+    offset, width, height, bpp = read_bmp(data)
+    bytes_pp = bpp // 8
+    stride = (width * bytes_pp + 3) & ~3
+    top_down = height < 0
+    height = abs(height)
+
+    out = bytearray()
+    for y in range(height):
+        src_y = y if top_down else height - 1 - y
+        line = offset + src_y * stride
+        for x in range(width):
+            b, g, r = data[line + x * bytes_pp: line + x * bytes_pp + 3]
+            out += struct.pack("<H", convert_888_to_565(r, g, b))
+
+    return bytes(out), width, height
+
+
+def align_up(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the SD card asset pack.")
+    parser.add_argument("input_dir")
+    parser.add_argument("output")
+    parser.add_argument("--format", choices=("rgb565", "bmp"), default="rgb565",
+                        help="how images are stored (default: rgb565, converted for the display)")
+    parser.add_argument("--align", type=int, default=512,
+                        help="alignment of each entry in the file, the card sector or allocation unit size")
+    args = parser.parse_args()
+
+    entries = []
+    for name in sorted(os.listdir(args.input_dir)):
+        path = os.path.join(args.input_dir, name)
+        if not os.path.isfile(path) or name == os.path.basename(args.output):
+            continue
+        if len(name.encode()) >= NAME_LENGTH:
+            sys.exit("name too long for the pack: %s" % name)
+
+        data = open(path, "rb").read()
+        fmt, width, height = FORMAT_RAW, 0, 0
+
+        if name.lower().endswith(".bmp"):
+            if args.format == "rgb565":
+                data, width, height = bmp_to_rgb565(data)
+                fmt = FORMAT_RGB565
+            else:
+                _, width, height, _ = read_bmp(data)
+                height = abs(height)
+                fmt = FORMAT_BMP
+
+        entries.append((name, data, fmt, width, height))
+
+    data_start = align_up(HEADER.size + ENTRY.size * len(entries), args.align)
+
+    toc = bytearray()
+    blob = bytearray()
+    for name, data, fmt, width, height in entries:
+        offset = data_start + len(blob)
+        toc += ENTRY.pack(name.encode(), offset, len(data), fmt, width, height, 0)
+        blob += data
+        blob += bytes(align_up(len(blob), args.align) - len(blob))
+
+    with open(args.output, "wb") as out:
+        out.write(HEADER.pack(PACK_MAGIC, PACK_VERSION, len(entries), data_start))
+        out.write(toc)
+        out.write(bytes(data_start - HEADER.size - len(toc)))
+        out.write(blob)
+
+    for name, data, fmt, width, height in entries:
+        print("%-32s %8d bytes  %dx%d" % (name, len(data), width, height))
+    print("%d entries written to %s" % (len(entries), args.output))
+
+
+if __name__ == "__main__":
+    main()
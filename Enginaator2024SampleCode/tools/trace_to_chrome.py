@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+#
+# trace_to_chrome.py
+#
+#  Created on: 19 Oct 2026
+#      Author: Joonatan
+#
+# Converts a trace dumped by the firmware (main/trace.c) into Chrome trace JSON,
+# which can be opened in chrome://tracing or https://ui.perfetto.dev
+#
+# Usage: trace_to_chrome.py trace.txt trace.json
+#
+# Input lines:
+#   V <format version>
+#   T <cycle counter ticks per microsecond>
+#   S <core> <ticks> <microseconds>     shared timer sample, puts the core on a common time line
+#   E <core> <ticks> <B|E> <name>       trace event
+
+import json
+import sys
+
+FORMAT_VERSION = 1
+
+
+def convert(lines):
+    ticks_per_us = None
+    sync = {}       # core -> (ticks, unwrapped microseconds)
+    last_sync_us = {}
+    last_ts = {}    # core -> time of the previous event
+    events = []
+    skipped = 0
+
+    for line in lines:
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+
+        fields = line.split(" ", 4)
+
+        if fields[0] == "V":
+            if int(fields[1]) != FORMAT_VERSION:
+                sys.exit("unsupported trace format version %s" % fields[1])
+        elif fields[0] == "T":
+            ticks_per_us = int(fields[1])
+        elif fields[0] == "S":
+            core, ticks, us = int(fields[1]), int(fields[2]), int(fields[3])
+            # The microsecond value is 32 bits on the target as well.
+            if core in last_sync_us:
+                prev = last_sync_us[core]
+                us = prev + ((us - prev) & 0xffffffff)
+            last_sync_us[core] = us
+            sync[core] = (ticks, us)
+        elif fields[0] == "E":
+            core, ticks, phase, name = int(fields[1]), int(fields[2]), fields[3], fields[4]
+            if core not in sync:
+                # Older than the first timer sample of the buffer, cannot be placed.
+                skipped += 1
+                continue
+            sync_ticks, sync_us = sync[core]
+            ts = sync_us + ((ticks - sync_ticks) & 0xffffffff) / ticks_per_us
+            # The timer sample is whole microseconds, so events next to it can land up to a microsecond
+            # before the previous one. A core records in order, keep its time line from going backwards.
+            ts = max(ts, last_ts.get(core, ts))
+            last_ts[core] = ts
+            events.append({"name": name, "ph": phase, "ts": ts, "pid": 0, "tid": core})
+
+    if ticks_per_us is None:
+        sys.exit("no tick rate in the trace")
+
+    # Both cores record end events for work that began before the buffer window. Drop those.
+    open_scopes = {}
+    result = []
+    for event in sorted(events, key=lambda e: e["ts"]):
+        key = (event["tid"], event["name"])
+        if event["ph"] == "B":
+            open_scopes[key] = open_scopes.get(key, 0) + 1
+        elif open_scopes.get(key, 0) > 0:
+            open_scopes[key] -= 1
+        else:
+            skipped += 1
+            continue
+        result.append(event)
+
+    return result, skipped
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: trace_to_chrome.py trace.txt trace.json")
+
+    with open(sys.argv[1]) as f:
+        events, skipped = convert(f)
+
+    with open(sys.argv[2], "w") as f:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, f)
+
+    print("%d events written to %s, %d skipped" % (len(events), sys.argv[2], skipped))
+
+
+if __name__ == "__main__":
+    main()